@@ -0,0 +1,92 @@
+#include "takane/compressed_sparse_matrix.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+// Microbenchmark for the sparse index checks in compressed_sparse_matrix::validate(),
+// comparing the vectorized IndexChecker to the original element-wise loop.
+// Usage: sparse_indices [NUM_PRIMARY] [NUM_SECONDARY] [DENSITY]
+
+template<typename Index_>
+void reference(const std::vector<uint64_t>& indptrs, const std::vector<Index_>& indices, uint64_t secondary_dim) {
+    size_t which_ptr = 0;
+    uint64_t last_index = 0;
+    uint64_t limit = indptrs[0];
+    for (size_t i = 0, end = indices.size(); i < end; ++i) {
+        auto x = indices[i];
+        if (x >= secondary_dim) {
+            throw std::runtime_error("out-of-range index");
+        }
+        if (i == limit) {
+            do {
+                ++which_ptr;
+                limit = indptrs[which_ptr];
+            } while (i == limit);
+        } else if (last_index >= x) {
+            throw std::runtime_error("indices should be strictly increasing");
+        }
+        last_index = x;
+    }
+}
+
+template<typename Index_>
+void run(const std::string& name, size_t num_primary, size_t num_secondary, double density) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist;
+    std::vector<uint64_t> indptrs { 0 };
+    std::vector<Index_> indices;
+    for (size_t p = 0; p < num_primary; ++p) {
+        for (size_t s = 0; s < num_secondary; ++s) {
+            if (dist(rng) < density) {
+                indices.push_back(s);
+            }
+        }
+        indptrs.push_back(indices.size());
+    }
+
+    constexpr size_t block_size = 10000;
+    auto time = [&](auto fun) -> double {
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < 10; ++it) {
+            fun();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / 10;
+    };
+
+    double ref = time([&]() -> void {
+        reference(indptrs, indices, num_secondary);
+    });
+
+    double vec = time([&]() -> void {
+        takane::compressed_sparse_matrix::internal::IndexChecker<takane::compressed_sparse_matrix::internal::LoadedPointers> checker(
+            takane::compressed_sparse_matrix::internal::LoadedPointers(indptrs, 0),
+            num_secondary
+        );
+        for (size_t start = 0, end = indices.size(); start < end; start += block_size) {
+            size_t count = std::min(block_size, end - start);
+            checker.check(start, count, indices.data() + start);
+        }
+    });
+
+    std::cout << name << ": " << indices.size() << " non-zeros, reference " << ref << " ms, vectorized " << vec << " ms" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t num_primary = (argc > 1 ? std::stoull(argv[1]) : 10000);
+    size_t num_secondary = (argc > 2 ? std::stoull(argv[2]) : 20000);
+    double density = (argc > 3 ? std::stod(argv[3]) : 0.05);
+
+    if (num_secondary <= 65536) {
+        run<uint16_t>("uint16", num_primary, num_secondary, density);
+    }
+    run<uint32_t>("uint32", num_primary, num_secondary, density);
+    run<uint64_t>("uint64", num_primary, num_secondary, density);
+    return 0;
+}
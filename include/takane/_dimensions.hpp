@@ -67,6 +67,8 @@ inline auto default_registry() {
  * @return Vector containing the object's dimensions.
  */
 inline std::vector<size_t> dimensions(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
+    [[maybe_unused]] internal_cache::SessionScope scope(options.session_cache, options.cache_results);
+
     auto cIt = options.custom_dimensions.find(metadata.type);
     if (cIt != options.custom_dimensions.end()) {
         return (cIt->second)(path, metadata, options);
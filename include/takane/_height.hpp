@@ -86,6 +86,8 @@ inline auto default_registry() {
  * @return The object's height.
  */
 inline size_t height(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
+    [[maybe_unused]] internal_cache::SessionScope scope(options.session_cache, options.cache_results);
+
     auto cIt = options.custom_height.find(metadata.type);
     if (cIt != options.custom_height.end()) {
         return (cIt->second)(path, metadata, options);
@@ -107,6 +107,9 @@ inline auto default_registry() {
  * @param options Validation options.
  */
 inline void validate(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
+    // Intermediate results are only cached for the duration of the top-level call.
+    [[maybe_unused]] internal_cache::SessionScope scope(options.session_cache, options.cache_results);
+
     auto cIt = options.custom_validate.find(metadata.type);
 
     if (cIt != options.custom_validate.end()) {
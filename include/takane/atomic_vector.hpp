@@ -10,6 +10,7 @@
 
 #include "utils_public.hpp"
 #include "utils_string.hpp"
+#include "utils_hdf5.hpp"
 #include "utils_json.hpp"
 
 /**
@@ -54,7 +55,7 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         vlen = ritsuko::hdf5::get_1d_length(phandle.getSpace(), false);
         auto hhandle = ritsuko::hdf5::vls::open_heap(ghandle, "heap");
         auto hlen = ritsuko::hdf5::get_1d_length(hhandle.getSpace(), false);
-        ritsuko::hdf5::vls::validate_1d_array<uint64_t, uint64_t>(phandle, vlen, hlen, options.hdf5_buffer_size);
+        internal_hdf5::validate_vls_pointers(phandle, std::vector<hsize_t>{ vlen }, hhandle, hlen, options.hdf5_buffer_size, options.num_threads, options.validate_utf8);
 
         if (phandle.attrExists(missing_attr_name)) {
             auto attr = phandle.openAttribute(missing_attr_name);
@@ -71,7 +72,7 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
             }
             auto missingness = ritsuko::hdf5::open_and_load_optional_string_missing_placeholder(dhandle, missing_attr_name);
             std::string format = internal_string::fetch_format_attribute(ghandle);
-            internal_string::validate_string_format(dhandle, vlen, format, missingness, options.hdf5_buffer_size);
+            internal_string::validate_string_format(dhandle, vlen, format, missingness, options.hdf5_buffer_size, options.validate_utf8);
 
         } else {
             if (type == "integer") {
@@ -97,7 +98,7 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         }
     }
 
-    internal_string::validate_names(ghandle, "names", vlen, options.hdf5_buffer_size);
+    internal_string::validate_names(ghandle, "names", vlen, options.hdf5_buffer_size, options.validate_utf8);
 }
 
 /**
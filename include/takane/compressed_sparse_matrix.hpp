@@ -7,6 +7,9 @@
 #include "utils_public.hpp"
 #include "utils_array.hpp"
 #include "utils_json.hpp"
+#include "utils_hdf5.hpp"
+#include "utils_parallel.hpp"
+#include "utils_simd.hpp"
 
 #include <filesystem>
 #include <stdexcept>
@@ -14,6 +17,9 @@
 #include <cstdint>
 #include <array>
 #include <vector>
+#include <algorithm>
+#include <limits>
+#include <utility>
 
 /**
  * @file compressed_sparse_matrix.hpp
@@ -114,47 +120,228 @@ inline std::vector<uint64_t> validate_indptrs(const H5::Group& handle, size_t pr
     throw std::runtime_error("failed to validate sparse matrix pointers at '" + ritsuko::hdf5::get_name(handle) + "/indptr'; " + std::string(e.what()));
 }
 
-inline void validate_indices(const H5::Group& handle, const std::vector<uint64_t>& indptrs, uint64_t secondary_dim, const Options& options) try {
-    auto dhandle = ritsuko::hdf5::open_dataset(handle, "indices");
+// Same as validate_indptrs(), but without loading all pointers into memory.
+inline void validate_indptrs_streaming(const H5::Group& handle, size_t primary_dim, size_t num_nonzero, const Options& options) try {
+    auto dhandle = ritsuko::hdf5::open_dataset(handle, "indptr");
     if (ritsuko::hdf5::exceeds_integer_limit(dhandle, 64, false)) {
         throw std::runtime_error("expected datatype to be a subset of a 64-bit unsigned integer");
     }
 
-    auto len = ritsuko::hdf5::get_1d_length(dhandle.getSpace(), false);
-    if (indptrs.back() != len) {
-        throw std::runtime_error("dataset length should be equal to the number of non-zero elements (expected " + std::to_string(indptrs.back()) + ", got " + std::to_string(len) + ")");
+    size_t len = ritsuko::hdf5::get_1d_length(dhandle, false);
+    if (len != primary_dim + 1) {
+        throw std::runtime_error("dataset should have length equal to the primary dimension extent plus 1");
+    }
+
+    // Deferring the sortedness error until the first and last entries are checked, for consistency with validate_indptrs().
+    uint64_t first = 0, previous = 0;
+    bool sorted = true;
+    internal_hdf5::iterate_1d_integer_blocks<uint64_t>(dhandle, len, options.hdf5_buffer_size, options.hdf5_memory_map, [&](hsize_t start, hsize_t count, const auto* ptrs) {
+        if (start == 0) {
+            first = ptrs[0];
+            previous = ptrs[0];
+        }
+        for (hsize_t i = 0; i < count; ++i) {
+            sorted &= (ptrs[i] >= previous);
+            previous = ptrs[i];
+        }
+    });
+
+    if (first != 0) {
+        throw std::runtime_error("first entry should be zero");
+    }
+    if (previous != num_nonzero) {
+        throw std::runtime_error("last entry should equal the number of non-zero elements");
+    }
+    if (!sorted) {
+        throw std::runtime_error("pointers should be sorted in increasing order");
+    }
+} catch (std::exception& e) {
+    throw std::runtime_error("failed to validate sparse matrix pointers at '" + ritsuko::hdf5::get_name(handle) + "/indptr'; " + std::string(e.what()));
+}
+
+// Sources of pointers for the IndexChecker. Each pointer source only needs
+// to provide the current pointer and advance to the next one.
+class LoadedPointers {
+public:
+    LoadedPointers(const std::vector<uint64_t>& indptrs, size_t which_ptr) : my_indptrs(indptrs), my_which_ptr(which_ptr) {}
+
+    uint64_t get() const {
+        return my_indptrs[my_which_ptr];
+    }
+
+    uint64_t next() {
+        ++my_which_ptr;
+        return my_indptrs[my_which_ptr];
+    }
+
+private:
+    const std::vector<uint64_t>& my_indptrs;
+    size_t my_which_ptr;
+};
+
+class StreamedPointers {
+public:
+    StreamedPointers(const H5::DataSet* handle, hsize_t len, hsize_t buffer_size) : my_stream(handle, len, buffer_size) {}
+
+    uint64_t get() {
+        return my_stream.get();
+    }
+
+    uint64_t next() {
+        my_stream.next();
+        return my_stream.get();
     }
 
-    size_t which_ptr = 0;
-    uint64_t last_index = 0;
-    hsize_t limit = indptrs[0];
-    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> stream(&dhandle, len, options.hdf5_buffer_size);
+private:
+    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> my_stream;
+};
+
+// Checks the indices from a contiguous range of non-zero elements. The
+// current pointer in 'pointers' should be the first pointer that is equal to
+// the start of the range, so ranges starting at any primary dimension element
+// can be checked independently.
+template<class Pointers_>
+class IndexChecker {
+public:
+    IndexChecker(Pointers_ pointers, uint64_t secondary_dim) : 
+        my_pointers(std::move(pointers)), my_limit(my_pointers.get()), my_secondary_dim(secondary_dim) {}
+
+    template<typename Index_>
+    void check(hsize_t start, hsize_t count, const Index_* values) {
+        if (count == 0) {
+            return;
+        }
+
+        // The first value is compared to the last value of the previous block.
+        check_one(start, values[0]);
+        constexpr uint64_t type_max = std::numeric_limits<Index_>::max();
+        Index_ max_allowed = static_cast<Index_>(std::min(my_secondary_dim - 1, type_max)); // no underflow as check_one() would have thrown.
+
+        // Jumping to the next value that is out of range or not greater than
+        // its predecessor. This is either the start of a new primary dimension
+        // element (in which case we update our pointers and continue) or an
+        // error (in which case check_one() will throw).
+        hsize_t pos = 1;
+        while (pos < count) {
+            hsize_t next = internal_simd::find_unsorted_or_out_of_range(values, pos, count, max_allowed);
+            if (next == count) {
+                break;
+            }
+            hsize_t i = start + next;
+            while (my_limit < i) {
+                my_limit = my_pointers.next();
+            }
+            my_last_index = values[next - 1];
+            check_one(i, values[next]);
+            pos = next + 1;
+        }
+
+        // Skipping over any pointers in the remainder of the block.
+        hsize_t last = start + count - 1;
+        while (my_limit <= last) {
+            my_limit = my_pointers.next();
+        }
+        my_last_index = values[count - 1];
+    }
 
-    for (hsize_t i = 0; i < len; ++i, stream.next()) {
-        auto x = stream.get();
-        if (x >= secondary_dim) {
+private:
+    void check_one(hsize_t i, uint64_t x) {
+        if (x >= my_secondary_dim) {
             throw std::runtime_error("out-of-range index (" + std::to_string(x) + ")");
         }
 
-        if (i == limit) {
+        if (i == my_limit) {
             // No need to check if there are more or fewer elements
             // than expected, as we already know that indptr.back()
             // is equal to the number of non-zero elements.
             do {
-                ++which_ptr;
-                limit = indptrs[which_ptr];
-            } while (i == limit);
-        } else if (last_index >= x) {
+                my_limit = my_pointers.next();
+            } while (i == my_limit);
+        } else if (my_last_index >= x) {
             throw std::runtime_error("indices should be strictly increasing");
         }
 
-        last_index = x;
+        my_last_index = x;
+    }
+
+private:
+    Pointers_ my_pointers;
+    hsize_t my_limit;
+    uint64_t my_secondary_dim;
+    uint64_t my_last_index = 0;
+};
+
+inline H5::DataSet open_indices(const H5::Group& handle, uint64_t num_nonzero) {
+    auto dhandle = ritsuko::hdf5::open_dataset(handle, "indices");
+    if (ritsuko::hdf5::exceeds_integer_limit(dhandle, 64, false)) {
+        throw std::runtime_error("expected datatype to be a subset of a 64-bit unsigned integer");
+    }
+
+    auto len = ritsuko::hdf5::get_1d_length(dhandle.getSpace(), false);
+    if (num_nonzero != len) {
+        throw std::runtime_error("dataset length should be equal to the number of non-zero elements (expected " + std::to_string(num_nonzero) + ", got " + std::to_string(len) + ")");
+    }
+
+    return dhandle;
+}
+
+inline void validate_indices(const H5::Group& handle, const std::vector<uint64_t>& indptrs, uint64_t secondary_dim, const Options& options) try {
+    auto dhandle = open_indices(handle, indptrs.back());
+    hsize_t len = indptrs.back();
+
+    if (options.num_threads <= 1 || len <= options.hdf5_buffer_size) {
+        IndexChecker<LoadedPointers> checker(LoadedPointers(indptrs, 0), secondary_dim);
+        internal_hdf5::iterate_1d_integer_blocks<uint64_t>(dhandle, len, options.hdf5_buffer_size, options.hdf5_memory_map, [&](hsize_t start, hsize_t count, const auto* values) {
+            checker.check(start, count, values);
+        });
+        return;
+    }
+
+    // Splitting the non-zero elements into ranges that start at the boundary
+    // of a primary dimension element, so each range can be checked
+    // independently. We use more ranges than threads for better load balancing.
+    size_t num_jobs = static_cast<size_t>(options.num_threads) * 4;
+    std::vector<hsize_t> boundaries { 0 };
+    std::vector<size_t> first_ptrs { 0 };
+    for (size_t j = 1; j < num_jobs; ++j) {
+        hsize_t target = (len / num_jobs) * j;
+        auto it = std::lower_bound(indptrs.begin(), indptrs.end(), target);
+        hsize_t bound = *it;
+        if (bound > boundaries.back() && bound < len) {
+            boundaries.push_back(bound);
+            first_ptrs.push_back(it - indptrs.begin());
+        }
     }
+    boundaries.push_back(len);
+
+    internal_hdf5::dispatch_integer_type<uint64_t>(dhandle, [&](auto tag) -> void {
+        typedef decltype(tag) Index_;
+        internal_hdf5::ConcurrentBlockReader<Index_> reader(dhandle, len, options.hdf5_memory_map);
+        internal_parallel::parallelize(first_ptrs.size(), options.num_threads, [&](size_t job) -> void {
+            IndexChecker<LoadedPointers> checker(LoadedPointers(indptrs, first_ptrs[job]), secondary_dim);
+            reader.iterate(boundaries[job], boundaries[job + 1], options.hdf5_buffer_size, [&](hsize_t start, hsize_t count, const Index_* values) {
+                checker.check(start, count, values);
+            });
+        });
+    });
 
 } catch (std::exception& e) {
     throw std::runtime_error("failed to validate sparse matrix indices at '" + ritsuko::hdf5::get_name(handle) + "/indices'; " + std::string(e.what()));
 }
 
+// Same as validate_indices(), but streaming through the pointers alongside
+// the indices. This assumes that validate_indptrs_streaming() was already run.
+inline void validate_indices_streaming(const H5::Group& handle, size_t primary_dim, uint64_t num_nonzero, uint64_t secondary_dim, const Options& options) try {
+    auto dhandle = open_indices(handle, num_nonzero);
+    auto phandle = handle.openDataSet("indptr");
+    IndexChecker<StreamedPointers> checker(StreamedPointers(&phandle, primary_dim + 1, options.hdf5_buffer_size), secondary_dim);
+    internal_hdf5::iterate_1d_integer_blocks<uint64_t>(dhandle, num_nonzero, options.hdf5_buffer_size, options.hdf5_memory_map, [&](hsize_t start, hsize_t count, const auto* values) {
+        checker.check(start, count, values);
+    });
+} catch (std::exception& e) {
+    throw std::runtime_error("failed to validate sparse matrix indices at '" + ritsuko::hdf5::get_name(handle) + "/indices'; " + std::string(e.what()));
+}
+
 }
 /**
  * @endcond
@@ -185,8 +372,15 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
 
     auto shape = internal::validate_shape(ghandle, options);
     size_t num_nonzero = internal::validate_data(ghandle, options);
-    auto indptrs = internal::validate_indptrs(ghandle, shape[primary], num_nonzero);
-    internal::validate_indices(ghandle, indptrs, shape[1 - primary], options);
+
+    // Only loading the pointers into memory if they fit into our budget.
+    if (shape[primary] < options.compressed_sparse_matrix_indptr_memory_limit / sizeof(uint64_t)) {
+        auto indptrs = internal::validate_indptrs(ghandle, shape[primary], num_nonzero);
+        internal::validate_indices(ghandle, indptrs, shape[1 - primary], options);
+    } else {
+        internal::validate_indptrs_streaming(ghandle, shape[primary], num_nonzero, options);
+        internal::validate_indices_streaming(ghandle, shape[primary], num_nonzero, shape[1 - primary], options);
+    }
 
     if (ghandle.exists("names")) {
         std::vector<hsize_t> dims(shape.begin(), shape.end());
@@ -8,16 +8,21 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <vector>
 #include <filesystem>
-#include <unordered_set>
+#include <algorithm>
+#include <memory>
 
 #include "utils_public.hpp"
 #include "utils_string.hpp"
 #include "utils_factor.hpp"
 #include "utils_other.hpp"
 #include "utils_json.hpp"
+#include "utils_hash.hpp"
+#include "utils_hdf5.hpp"
+#include "utils_parallel.hpp"
 
 /**
  * @file data_frame.hpp
@@ -53,7 +58,7 @@ inline void validate_row_names(const H5::Group& handle, hsize_t num_rows, const
     if (ritsuko::hdf5::get_1d_length(rnhandle.getSpace(), false) != num_rows) {
         throw std::runtime_error("expected 'row_names' to have length equal to the number of rows");
     }
-    ritsuko::hdf5::validate_1d_string_dataset(rnhandle, num_rows, options.hdf5_buffer_size);
+    internal_hdf5::validate_1d_strings(rnhandle, num_rows, options.hdf5_buffer_size, options.validate_utf8);
 } catch (std::exception& e) {
     throw std::runtime_error("failed to validate the row names for '" + ritsuko::hdf5::get_name(handle) + "'; " + std::string(e.what()));
 }
@@ -66,18 +71,16 @@ inline hsize_t validate_column_names(const H5::Group& ghandle, const Options& op
     
     auto num_cols = ritsuko::hdf5::get_1d_length(cnhandle.getSpace(), false);
 
-    std::unordered_set<std::string> column_names;
-    ritsuko::hdf5::Stream1dStringDataset stream(&cnhandle, num_cols, options.hdf5_buffer_size);
-    for (size_t c = 0; c < num_cols; ++c, stream.next()) {
-        auto x = stream.steal();
+    internal_hash::StringSet column_names;
+    column_names.reserve(std::min<hsize_t>(num_cols, internal_hash::StringSet::max_reserve()));
+    internal_hdf5::iterate_1d_strings(cnhandle, num_cols, options.hdf5_buffer_size, [&](hsize_t, std::string_view x) -> void {
         if (x.empty()) {
             throw std::runtime_error("column names should not be empty strings");
         }
-        if (column_names.find(x) != column_names.end()) {
-            throw std::runtime_error("duplicated column name '" + x + "'");
+        if (!column_names.insert(x)) {
+            throw std::runtime_error("duplicated column name '" + std::string(x) + "'");
         }
-        column_names.insert(std::move(x));
-    }
+    }, options.validate_utf8);
 
     return num_cols;
 
@@ -85,18 +88,17 @@ inline hsize_t validate_column_names(const H5::Group& ghandle, const Options& op
     throw std::runtime_error("failed to validate the column names for '" + ritsuko::hdf5::get_name(ghandle) + "'; " + std::string(e.what()));
 }
 
-inline void validate_column(const H5::Group& dhandle, const std::string& dset_name, hsize_t num_rows, const ritsuko::Version& version, const Options& options) try { 
+inline void validate_column(const H5::Group& dhandle, const std::string& dset_name, H5O_type_t dtype, hsize_t num_rows, const ritsuko::Version& version, const Options& options) try { 
     const char* missing_attr_name = "missing-value-placeholder";
 
-    auto dtype = dhandle.childObjType(dset_name);
     if (dtype == H5O_TYPE_GROUP) {
         auto ghandle = dhandle.openGroup(dset_name);
         auto type = ritsuko::hdf5::open_and_load_scalar_string_attribute(ghandle, "type");
 
         if (type == "factor") {
             internal_factor::check_ordered_attribute(ghandle);
-            auto num_levels = internal_factor::validate_factor_levels(ghandle, "levels", options.hdf5_buffer_size);
-            auto num_codes = internal_factor::validate_factor_codes(ghandle, "codes", num_levels, options.hdf5_buffer_size);
+            auto num_levels = internal_factor::validate_factor_levels(ghandle, "levels", options.hdf5_buffer_size, options.validate_utf8);
+            auto num_codes = internal_factor::validate_factor_codes(ghandle, "codes", num_levels, options.hdf5_buffer_size, /* allow_missing = */ true, options.hdf5_memory_map);
             if (num_codes != num_rows) {
                 throw std::runtime_error("expected column to have length equal to the number of rows");
             }
@@ -114,7 +116,7 @@ inline void validate_column(const H5::Group& dhandle, const std::string& dset_na
 
             auto hhandle = ritsuko::hdf5::vls::open_heap(ghandle, "heap");
             auto hlen = ritsuko::hdf5::get_1d_length(hhandle.getSpace(), false);
-            ritsuko::hdf5::vls::validate_1d_array<uint64_t, uint64_t>(phandle, vlen, hlen, options.hdf5_buffer_size);
+            internal_hdf5::validate_vls_pointers(phandle, std::vector<hsize_t>{ vlen }, hhandle, hlen, options.hdf5_buffer_size, options.num_threads, options.validate_utf8);
 
             if (phandle.attrExists(missing_attr_name)) {
                 auto attr = phandle.openAttribute(missing_attr_name);
@@ -138,7 +140,7 @@ inline void validate_column(const H5::Group& dhandle, const std::string& dset_na
             }
             auto missingness = ritsuko::hdf5::open_and_load_optional_string_missing_placeholder(xhandle, missing_attr_name);
             std::string format = internal_string::fetch_format_attribute(xhandle);
-            internal_string::validate_string_format(xhandle, num_rows, format, missingness, options.hdf5_buffer_size);
+            internal_string::validate_string_format(xhandle, num_rows, format, missingness, options.hdf5_buffer_size, options.validate_utf8);
 
         } else {
             if (type == "integer") {
@@ -207,28 +209,33 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     // Finally iterating through the columns.
     auto dhandle = ritsuko::hdf5::open_group(ghandle, "data");
 
-    hsize_t num_basic = 0;
+    internal_hdf5::IndexedChildren children(dhandle, NC);
     auto other_dir = path / "other_columns";
-
-    for (size_t c = 0; c < NC; ++c) {
+    // Columns may be validated in parallel, in which case each column gets
+    // its own copy of the options; see Options::num_threads.
+    internal_parallel::parallelize_objects(NC, options, [&](size_t c, Options& column_options) -> void {
         std::string dset_name = std::to_string(c);
 
-        if (!dhandle.exists(dset_name)) {
+        if (!children.exists(c)) {
             auto opath = other_dir / dset_name;
             auto ometa = read_object_metadata(opath);
             try {
-                ::takane::validate(opath, ometa, options);
+                ::takane::validate(opath, ometa, column_options);
             } catch (std::exception& e) {
                 throw std::runtime_error("failed to validate 'other' column " + dset_name + "; " + std::string(e.what()));
             }
-            if (::takane::height(opath, ometa, options) != num_rows) {
+            if (::takane::height(opath, ometa, column_options) != num_rows) {
                 throw std::runtime_error("height of column " + dset_name + " of class '" + ometa.type + "' is not the same as the number of rows");
             }
 
         } else {
-            validate_column(dhandle, dset_name, num_rows, version, options);
-            ++num_basic;
+            validate_column(dhandle, dset_name, children.type(c), num_rows, version, column_options);
         }
+    });
+
+    hsize_t num_basic = 0;
+    for (size_t c = 0; c < NC; ++c) {
+        num_basic += children.exists(c);
     }
 
     if (std::filesystem::exists(other_dir)) {
@@ -237,7 +244,7 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         }
     }
 
-    if (num_basic != dhandle.getNumObjs()) {
+    if (num_basic != children.size()) {
         throw std::runtime_error("more objects present in the 'data_frame/data' group than expected");
     }
 
@@ -74,12 +74,12 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
 
     auto handle = ritsuko::hdf5::open_file(path / "contents.h5");
     auto ghandle = ritsuko::hdf5::open_group(handle, type_name.c_str());
-    size_t num_codes = internal_factor::validate_factor_codes(ghandle, "codes", num_levels, options.hdf5_buffer_size, /* allow_missing = */ false);
+    size_t num_codes = internal_factor::validate_factor_codes(ghandle, "codes", num_levels, options.hdf5_buffer_size, /* allow_missing = */ false, options.hdf5_memory_map);
 
     internal_other::validate_mcols(path, "element_annotations", num_codes, options);
     internal_other::validate_metadata(path, "other_annotations", options);
 
-    internal_string::validate_names(ghandle, "names", num_codes, options.hdf5_buffer_size);
+    internal_string::validate_names(ghandle, "names", num_codes, options.hdf5_buffer_size, options.validate_utf8);
 }
 
 /**
@@ -7,12 +7,20 @@
 
 #include "utils_public.hpp"
 #include "utils_other.hpp"
+#include "utils_hdf5.hpp"
+#include "utils_parallel.hpp"
+#include "utils_cache.hpp"
 
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <filesystem>
 #include <cstdint>
+#include <unordered_map>
+#include <exception>
+#include <algorithm>
+#include <memory>
+#include <optional>
 
 /**
  * @file delayed_array.hpp
@@ -56,6 +64,75 @@ private:
     bool old;
 };
 
+// Result of validating a seed, which is stored so that each seed is only
+// validated once, no matter how many times it is referenced in 'array.h5'.
+struct SeedResult {
+    std::vector<size_t> dimensions;
+    std::exception_ptr error;
+};
+
+inline SeedResult validate_seed(const std::filesystem::path& seed_path, Options& options) {
+    SeedResult output;
+    try {
+        auto seed_meta = read_object_metadata(seed_path);
+        ::takane::validate(seed_path, seed_meta, options);
+        output.dimensions = ::takane::dimensions(seed_path, seed_meta, options);
+    } catch (...) {
+        output.error = std::current_exception();
+    }
+    return output;
+}
+
+inline uint64_t load_seed_index(const H5::Group& handle) {
+    auto dhandle = ritsuko::hdf5::open_dataset(handle, "index");
+    if (ritsuko::hdf5::exceeds_integer_limit(dhandle, 64, false)) {
+        throw std::runtime_error("'index' should have a datatype that fits into a 64-bit unsigned integer");
+    }
+    return ritsuko::hdf5::load_scalar_numeric_dataset<uint64_t>(dhandle);
+}
+
+// Parent objects typically query the dimensions of a delayed array several
+// times, including just after validation, so we cache them for the rest of
+// the session, i.e., the top-level validate(), height() or dimensions() call.
+// The key is based on the identity of 'array.h5' rather than its contents, so
+// that a cache hit does not need to read the file. No key is returned if
+// results should not be cached in the current session.
+inline std::optional<std::string> dimensions_cache_key(const std::filesystem::path& path, const Options& options) {
+    if (!internal_cache::usable_session_cache(options)) {
+        return std::nullopt;
+    }
+    auto id = internal_cache::identify_file(path / "array.h5");
+    if (!id.has_value()) {
+        return id;
+    }
+    return "delayed_array:" + *id;
+}
+
+inline std::shared_ptr<const std::vector<size_t> > fetch_dimensions(const std::filesystem::path& path, Options& options) {
+    auto key = dimensions_cache_key(path, options);
+    if (key.has_value()) {
+        auto found = internal_cache::usable_session_cache(options)->find<std::vector<size_t> >(*key);
+        if (found) {
+            return found;
+        }
+    }
+
+    auto& chihaya_options = options.delayed_array_options;
+    [[maybe_unused]] DetailsOnlyResetter o(chihaya_options);
+    chihaya_options.details_only = true;
+
+    auto apath = path / "array.h5";
+    auto fhandle = ritsuko::hdf5::open_file(apath);
+    auto ghandle = ritsuko::hdf5::open_group(fhandle, "delayed_array");
+    auto details = chihaya::validate(ghandle, chihaya_options);
+    auto output = std::make_shared<const std::vector<size_t> >(details.dimensions.begin(), details.dimensions.end());
+
+    if (key.has_value()) {
+        internal_cache::usable_session_cache(options)->store(*key, output);
+    }
+    return output;
+}
+
 }
 /**
  * @endcond
@@ -75,6 +152,7 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     }
 
     uint64_t max = 0;
+    std::vector<size_t> array_dims;
     {
         std::string custom_name = "custom takane seed array";
         auto& custom_options = options.delayed_array_options;
@@ -86,9 +164,10 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         // checks for valid references to external arrays in 'seeds/'.
         //
         // Note that we respect any existing 'custom takane seed array' setting
-        // - possibly from recursive calls to 'delayed_array::validate()', but
-        // also possibly from user-provided overrides, in which case we assume
-        // that the caller really knows what they're doing.
+        // from user-provided overrides, in which case we assume that the
+        // caller really knows what they're doing. (Recursive calls to
+        // 'delayed_array::validate()' for seeds do not see our validator, see
+        // below.)
         //
         // Anyway, all this means that we only mutate chihaya::Options if there
         // is no existing custom takane function. However, if we do so, we need
@@ -108,21 +187,28 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         };
         [[maybe_unused]] ValidateResetter v(custom_options, custom_name, custom_found);
 
+        // Seeds are validated with a copy of the options that lacks our
+        // validator, so that any nested delayed arrays will use their own
+        // validator for their own seeds. This also means that we can safely
+        // validate seeds in parallel without touching our own state.
+        Options seed_options = options;
+        std::unordered_map<uint64_t, internal::SeedResult> seeds;
+
         if (!custom_found) {
             custom_options.array_validate_registry[custom_name] = [&](const H5::Group& handle, const ritsuko::Version& version, chihaya::Options& ch_options) -> chihaya::ArrayDetails {
                 auto details = chihaya::custom_array::validate(handle, version, ch_options);
+                auto index = internal::load_seed_index(handle);
 
-                auto dhandle = ritsuko::hdf5::open_dataset(handle, "index");
-                if (ritsuko::hdf5::exceeds_integer_limit(dhandle, 64, false)) {
-                    throw std::runtime_error("'index' should have a datatype that fits into a 64-bit unsigned integer");
+                auto sIt = seeds.find(index);
+                if (sIt == seeds.end()) {
+                    sIt = seeds.emplace(index, internal::validate_seed(path / "seeds" / std::to_string(index), seed_options)).first;
+                }
+                const auto& seed = sIt->second;
+                if (seed.error) {
+                    std::rethrow_exception(seed.error);
                 }
 
-                auto index = ritsuko::hdf5::load_scalar_numeric_dataset<uint64_t>(dhandle);
-                auto seed_path = path / "seeds" / std::to_string(index);
-                auto seed_meta = read_object_metadata(seed_path);
-                ::takane::validate(seed_path, seed_meta, options);
-
-                auto seed_dims = ::takane::dimensions(seed_path, seed_meta, options);
+                const auto& seed_dims = seed.dimensions;
                 if (seed_dims.size() != details.dimensions.size()) {
                     throw std::runtime_error("dimensionality of 'seeds/" + std::to_string(index) + "' is not consistent with 'dimensions'");
                 }
@@ -151,9 +237,44 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         // Again, using RAII to reset the 'details_only' flag to its original
         // state after we're done with it.
         [[maybe_unused]] internal::DetailsOnlyResetter o(custom_options);
-        custom_options.details_only = false;
 
-        chihaya::validate(ghandle, chihaya_version, custom_options);
+        if (!custom_found && internal_parallel::can_parallelize_objects(options)) {
+            // Collecting all referenced seeds with a quick pass over the
+            // graph, so that we can validate them in parallel beforehand.
+            // The full validation below then uses the stored results, which
+            // ensures that we report the same error as a serial validation.
+            std::vector<uint64_t> referenced;
+            auto& validator = custom_options.array_validate_registry[custom_name];
+            auto full_validator = std::move(validator);
+            validator = [&](const H5::Group& handle, const ritsuko::Version& version, chihaya::Options& ch_options) -> chihaya::ArrayDetails {
+                auto details = chihaya::custom_array::validate(handle, version, ch_options);
+                referenced.push_back(internal::load_seed_index(handle));
+                return details;
+            };
+
+            custom_options.details_only = true;
+            try {
+                chihaya::validate(ghandle, chihaya_version, custom_options);
+            } catch (std::exception&) {
+                referenced.clear(); // any errors will be reported by the full validation.
+            }
+            validator = std::move(full_validator);
+
+            std::sort(referenced.begin(), referenced.end());
+            referenced.erase(std::unique(referenced.begin(), referenced.end()), referenced.end());
+            size_t num_seeds = referenced.size();
+            std::vector<internal::SeedResult> results(num_seeds);
+            internal_parallel::parallelize_objects(num_seeds, seed_options, [&](size_t s, Options& job_options) -> void {
+                results[s] = internal::validate_seed(path / "seeds" / std::to_string(referenced[s]), job_options);
+            });
+            for (size_t s = 0; s < num_seeds; ++s) {
+                seeds.emplace(referenced[s], std::move(results[s]));
+            }
+        }
+
+        custom_options.details_only = false;
+        auto details = chihaya::validate(ghandle, chihaya_version, custom_options);
+        array_dims.insert(array_dims.end(), details.dimensions.begin(), details.dimensions.end());
     }
 
     size_t found = 0;
@@ -164,6 +285,12 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     if (max != found) {
         throw std::runtime_error("number of objects in 'seeds' is not consistent with the number of 'index' references in 'array.h5'");
     }
+
+    // Saving the dimensions for subsequent calls to height() or dimensions().
+    auto key = internal::dimensions_cache_key(path, options);
+    if (key.has_value()) {
+        internal_cache::usable_session_cache(options)->store(*key, std::make_shared<const std::vector<size_t> >(std::move(array_dims)));
+    }
 }
 
 /**
@@ -173,15 +300,7 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
  * @return Extent of the first dimension.
  */
 inline size_t height(const std::filesystem::path& path, [[maybe_unused]] const ObjectMetadata& metadata, Options& options) {
-    auto& chihaya_options = options.delayed_array_options;
-    [[maybe_unused]] internal::DetailsOnlyResetter o(chihaya_options);
-    chihaya_options.details_only = true;
-
-    auto apath = path / "array.h5";
-    auto fhandle = ritsuko::hdf5::open_file(apath);
-    auto ghandle = ritsuko::hdf5::open_group(fhandle, "delayed_array");
-    auto output = chihaya::validate(ghandle, chihaya_options);
-    return output.dimensions[0];
+    return internal::fetch_dimensions(path, options)->front();
 }
 
 /**
@@ -191,15 +310,7 @@ inline size_t height(const std::filesystem::path& path, [[maybe_unused]] const O
  * @return Dimensions of the array.
  */
 inline std::vector<size_t> dimensions(const std::filesystem::path& path, [[maybe_unused]] const ObjectMetadata& metadata, Options& options) {
-    auto& chihaya_options = options.delayed_array_options;
-    [[maybe_unused]] internal::DetailsOnlyResetter o(chihaya_options);
-    chihaya_options.details_only = true;
-
-    auto apath = path / "array.h5";
-    auto fhandle = ritsuko::hdf5::open_file(apath);
-    auto ghandle = ritsuko::hdf5::open_group(fhandle, "delayed_array");
-    auto output = chihaya::validate(ghandle, chihaya_options);
-    return std::vector<size_t>(output.dimensions.begin(), output.dimensions.end());
+    return *(internal::fetch_dimensions(path, options));
 }
 
 }
@@ -7,6 +7,7 @@
 
 #include "utils_public.hpp"
 #include "utils_array.hpp"
+#include "utils_hdf5.hpp"
 
 #include <vector>
 #include <string>
@@ -93,7 +94,7 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         internal::retrieve_dimension_extents(phandle, extents);
         auto hhandle = ritsuko::hdf5::vls::open_heap(ghandle, "heap");
         auto hlen = ritsuko::hdf5::get_1d_length(hhandle.getSpace(), false);
-        ritsuko::hdf5::vls::validate_nd_array<uint64_t, uint64_t>(phandle, extents, hlen, options.hdf5_buffer_size);
+        internal_hdf5::validate_vls_pointers(phandle, extents, hhandle, hlen, options.hdf5_buffer_size, options.num_threads, options.validate_utf8);
 
         if (phandle.attrExists(missing_attr_name)) {
             auto attr = phandle.openAttribute(missing_attr_name);
@@ -108,7 +109,11 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
             if (!ritsuko::hdf5::is_utf8_string(dhandle)) {
                 throw std::runtime_error("expected string array to have a datatype that can be represented by a UTF-8 encoded string");
             }
-            ritsuko::hdf5::validate_nd_string_dataset(dhandle, extents, options.hdf5_buffer_size);
+            if (options.validate_utf8) {
+                internal_hdf5::validate_nd_strings(dhandle, extents, options.hdf5_buffer_size, /* check_utf8 = */ true);
+            } else {
+                ritsuko::hdf5::validate_nd_string_dataset(dhandle, extents, options.hdf5_buffer_size);
+            }
 
             if (dhandle.attrExists(missing_attr_name)) {
                 auto attr = dhandle.openAttribute(missing_attr_name);
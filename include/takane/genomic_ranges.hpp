@@ -11,11 +11,20 @@
 #include <cstdint>
 #include <type_traits>
 #include <limits>
+#include <vector>
+#include <optional>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include <memory>
 
 #include "utils_string.hpp"
 #include "utils_public.hpp"
 #include "utils_other.hpp"
 #include "utils_json.hpp"
+#include "utils_hdf5.hpp"
+#include "utils_parallel.hpp"
+#include "utils_cache.hpp"
 
 /**
  * @file genomic_ranges.hpp
@@ -45,9 +54,14 @@ namespace genomic_ranges {
 namespace internal {
 
 struct SequenceLimits {
-    SequenceLimits(size_t n) : has_circular(n), circular(n), has_seqlen(n), seqlen(n) {}
+    SequenceLimits(size_t n) : has_circular(n), circular(n), has_seqlen(n), seqlen(n), min_start(n), max_start(n), end_bound(n) {}
     std::vector<unsigned char> has_circular, circular, has_seqlen;
     std::vector<uint64_t> seqlen;
+
+    // A range on sequence 'i' is valid if 'min_start[i] <= start <= max_start[i]' and 'start + width <= end_bound[i]'.
+    // These are derived from the above so that each range can be checked without branching on the properties of its sequence.
+    std::vector<int64_t> min_start, max_start;
+    std::vector<uint64_t> end_bound;
 };
 
 inline SequenceLimits find_sequence_limits(const std::filesystem::path& path, Options& options) {
@@ -65,26 +79,230 @@ inline SequenceLimits find_sequence_limits(const std::filesystem::path& path, Op
 
     auto lhandle = ghandle.openDataSet("length");
     auto num_seq = ritsuko::hdf5::get_1d_length(lhandle.getSpace(), false);
-    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> lstream(&lhandle, num_seq, options.hdf5_buffer_size);
     auto lmissing = ritsuko::hdf5::open_and_load_optional_numeric_missing_placeholder<uint64_t>(lhandle, missing_attr_name);
 
     auto chandle = ghandle.openDataSet("circular");
-    ritsuko::hdf5::Stream1dNumericDataset<int32_t> cstream(&chandle, num_seq, options.hdf5_buffer_size);
     auto cmissing = ritsuko::hdf5::open_and_load_optional_numeric_missing_placeholder<int32_t>(chandle, missing_attr_name);
 
+    // Both columns are read together for each block; the lengths can go straight into the output.
     SequenceLimits output(num_seq);
-    for (size_t i = 0; i < num_seq; ++i, lstream.next(), cstream.next()) {
-        auto slen = lstream.get();
-        auto circ = cstream.get();
+    hsize_t block_size = std::max(options.hdf5_buffer_size, static_cast<hsize_t>(1));
+    std::vector<int32_t> cbuffer;
+    internal_hdf5::MultiRead batch;
+
+    for (hsize_t i = 0; i < num_seq; ++i) {
+        if (i % block_size == 0) {
+            hsize_t count = std::min(block_size, num_seq - i);
+            cbuffer.resize(count);
+            batch.clear();
+            batch.add(lhandle, output.seqlen.data() + i);
+            batch.add(chandle, cbuffer.data());
+            batch.run(i, count, num_seq);
+        }
+
+        auto slen = output.seqlen[i];
+        auto circ = cbuffer[i % block_size];
         output.has_seqlen[i] = !(lmissing.has_value() && *lmissing == slen);
-        output.seqlen[i] = slen;
         output.has_circular[i] = !(cmissing.has_value() && *cmissing == circ);
         output.circular[i] = circ;
+
+        // The end position must always fit in a 64-bit signed integer, see check_range().
+        constexpr int64_t max_i64 = std::numeric_limits<int64_t>::max();
+        output.min_start[i] = std::numeric_limits<int64_t>::min();
+        output.max_start[i] = max_i64;
+        output.end_bound[i] = max_i64;
+        if (output.has_circular[i] && !output.circular[i]) {
+            output.min_start[i] = 1;
+            if (output.has_seqlen[i] && slen < static_cast<uint64_t>(max_i64)) {
+                output.max_start[i] = slen;
+                output.end_bound[i] = slen + 1;
+            }
+        }
     }
 
     return output;
 }
 
+// Same as find_sequence_limits(), but re-using the results for identical
+// sequence information that was previously encountered in this session.
+inline std::shared_ptr<const SequenceLimits> find_sequence_limits_cached(const std::filesystem::path& path, Options& options) {
+    const std::string type_name = "sequence_information";
+    auto cache = internal_cache::usable_session_cache(options);
+    if (!cache) {
+        return std::make_shared<const SequenceLimits>(find_sequence_limits(path, options));
+    }
+
+    // Only caching the default validation, as custom functions might have side effects.
+    auto smeta = read_object_metadata(path);
+    if (smeta.type != type_name || options.custom_validate.find(smeta.type) != options.custom_validate.end()) {
+        return std::make_shared<const SequenceLimits>(find_sequence_limits(path, options));
+    }
+
+    // The key includes any options that affect the validation result.
+    auto key = type_name + ":" + (options.validate_utf8 ? "utf8" : "raw") + ":" + internal_cache::snapshot_files({ path / "OBJECT", path / "info.h5" });
+    auto found = cache->find<SequenceLimits>(key);
+    if (found) {
+        return found;
+    }
+
+    auto output = std::make_shared<const SequenceLimits>(find_sequence_limits(path, options));
+    cache->store(key, output);
+    return output;
+}
+
+// Checks a single range, reporting the precise reason for any failure.
+inline void check_range(uint64_t id, int64_t start, uint64_t width, const SequenceLimits& limits) {
+    if (id >= limits.seqlen.size()) {
+        throw std::runtime_error("'sequence' must be less than the number of sequences (got " + std::to_string(id) + ")");
+    }
+
+    // If it's definitely non-circular, the start position should be positive.
+    if (limits.has_circular[id] && !limits.circular[id]) {
+        if (start < 1) {
+            throw std::runtime_error("non-positive start position (" + std::to_string(start) + ") for non-circular sequence");
+        }
+
+        if (limits.has_seqlen[id]) {
+            // If the sequence length is provided, the end position shouldn't overflow.
+            auto spos = static_cast<uint64_t>(start);
+            auto limit = limits.seqlen[id];
+            if (spos > limit) {
+                throw std::runtime_error("start position beyond sequence length (" + std::to_string(start) + " > " + std::to_string(limit) + ") for non-circular sequence");
+            }
+
+            // The LHS should not overflow as 'spos >= 1' so 'limit - spos + 1' should still be no greater than 'limit'.
+            if (limit - spos + 1 < width) {
+                throw std::runtime_error("end position beyond sequence length (" + 
+                    std::to_string(start) + " + " + std::to_string(width) + " > " + std::to_string(limit) + 
+                    ") for non-circular sequence");
+            }
+        }
+    }
+
+    constexpr uint64_t end_limit = std::numeric_limits<int64_t>::max();
+    bool exceeded = false;
+    if (start > 0) {
+        // 'end_limit - start' is always non-negative as 'end_limit' is the largest value of an int64_t and 'start' is also int64_t.
+        exceeded = (end_limit - static_cast<uint64_t>(start) < width);
+    } else {
+        // 'end_limit - start' will not overflow a uint64_t, because 'end_limit' is the largest value of an int64_t and 'start' as also 'int64_t'.
+        exceeded = (end_limit + static_cast<uint64_t>(-start) < width);
+    }
+    if (exceeded) {
+        throw std::runtime_error("end position beyond the range of a 64-bit integer (" + std::to_string(start) + " + " + std::to_string(width) + ")");
+    }
+}
+
+// Reads all columns together in blocks that are distributed across threads.
+// Each block is first checked without branching by gathering the limits for
+// each range's sequence; we only use check_range() if any range fails, to
+// report the appropriate error. Invalid strands do not throw immediately,
+// instead returning the first offending value so that the caller can report
+// it after all other errors, consistent with a separate pass over 'strand'.
+template<typename Id_, typename Strand_>
+std::optional<Strand_> validate_ranges(
+    const H5::DataSet& id_handle,
+    const H5::DataSet& start_handle,
+    const H5::DataSet& width_handle,
+    const H5::DataSet* strand_handle,
+    hsize_t num_ranges,
+    const SequenceLimits& limits,
+    const Options& options)
+{
+    std::mutex lock;
+    internal_hdf5::ConcurrentBlockReader<Id_> id_reader(id_handle, num_ranges, options.hdf5_memory_map, lock);
+    internal_hdf5::ConcurrentBlockReader<int64_t> start_reader(start_handle, num_ranges, options.hdf5_memory_map, lock);
+    internal_hdf5::ConcurrentBlockReader<uint64_t> width_reader(width_handle, num_ranges, options.hdf5_memory_map, lock);
+    std::optional<internal_hdf5::ConcurrentBlockReader<Strand_> > strand_reader;
+    if (strand_handle) {
+        strand_reader.emplace(*strand_handle, num_ranges, options.hdf5_memory_map, lock);
+    }
+
+    hsize_t block_size = std::max(options.hdf5_buffer_size, static_cast<hsize_t>(1));
+    hsize_t num_blocks = (num_ranges + block_size - 1) / block_size;
+    size_t num_jobs = (options.num_threads > 1 ? std::min(static_cast<hsize_t>(options.num_threads) * 4, num_blocks) : 1);
+    hsize_t blocks_per_job = (num_jobs ? (num_blocks + num_jobs - 1) / num_jobs : 0);
+    std::vector<std::optional<Strand_> > bad_strands(num_jobs);
+
+    const uint64_t num_sequences = limits.seqlen.size();
+    const int64_t* min_start = limits.min_start.data();
+    const int64_t* max_start = limits.max_start.data();
+    const uint64_t* end_bound = limits.end_bound.data();
+
+    internal_parallel::parallelize(num_jobs, options.num_threads, [&](size_t job) -> void {
+        hsize_t job_start = std::min(num_ranges, job * blocks_per_job * block_size);
+        hsize_t job_end = std::min(num_ranges, job_start + blocks_per_job * block_size);
+        std::vector<Id_> id_buffer;
+        std::vector<int64_t> start_buffer;
+        std::vector<uint64_t> width_buffer;
+        std::vector<Strand_> strand_buffer;
+        auto& bad_strand = bad_strands[job];
+        internal_hdf5::MultiRead batch;
+
+        for (hsize_t block_start = job_start; block_start < job_end; block_start += block_size) {
+            hsize_t count = std::min(block_size, job_end - block_start);
+
+            // Reading all columns that aren't memory-mapped in a single call.
+            batch.clear();
+            auto ids = id_reader.fetch(block_start, count, id_buffer, batch);
+            auto starts = start_reader.fetch(block_start, count, start_buffer, batch);
+            auto widths = width_reader.fetch(block_start, count, width_buffer, batch);
+            const Strand_* strands = NULL;
+            bool check_strands = strand_reader.has_value() && !bad_strand.has_value();
+            if (check_strands) {
+                strands = strand_reader->fetch(block_start, count, strand_buffer, batch);
+            }
+            if (!batch.empty()) {
+                std::lock_guard<std::mutex> lck(lock);
+                batch.run(block_start, count, num_ranges);
+            }
+
+            // Accumulating flags without branching, so that the compiler has a chance to vectorize it.
+            bool failed = false;
+            for (hsize_t i = 0; i < count; ++i) {
+                failed |= (static_cast<uint64_t>(ids[i]) >= num_sequences);
+            }
+
+            if (!failed) {
+                for (hsize_t i = 0; i < count; ++i) {
+                    auto id = ids[i];
+                    auto start = starts[i];
+                    // If 'start <= max_start', 'end_bound - start' is exact as 'end_bound <= max_start + 1'; otherwise it doesn't matter as we already failed.
+                    failed |= (start < min_start[id]) | (start > max_start[id]) | (widths[i] > end_bound[id] - static_cast<uint64_t>(start));
+                }
+            }
+
+            if (failed) {
+                for (hsize_t i = 0; i < count; ++i) {
+                    check_range(ids[i], starts[i], widths[i], limits);
+                }
+            }
+
+            if (check_strands) {
+                bool invalid = false;
+                for (hsize_t i = 0; i < count; ++i) {
+                    invalid |= (strands[i] < -1) | (strands[i] > 1);
+                }
+                if (invalid) {
+                    for (hsize_t i = 0; i < count; ++i) {
+                        if (strands[i] < -1 || strands[i] > 1) {
+                            bad_strand = strands[i];
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    for (const auto& bad : bad_strands) {
+        if (bad.has_value()) {
+            return bad;
+        }
+    }
+    return std::nullopt;
+}
+
 }
 /**
  * @endcond
@@ -104,10 +322,10 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     }
 
     // Figuring out the sequence length constraints.
-    auto limits = internal::find_sequence_limits(path / "sequence_information", options);
-    size_t num_sequences = limits.seqlen.size();
+    auto limits_ptr = internal::find_sequence_limits_cached(path / "sequence_information", options);
+    const auto& limits = *limits_ptr;
 
-    // Now loading all three components.
+    // Now loading all of the components.
     auto handle = ritsuko::hdf5::open_file(path / "ranges.h5");
     auto ghandle = ritsuko::hdf5::open_group(handle, type_name.c_str());
     auto id_handle = ritsuko::hdf5::open_dataset(ghandle, "sequence");
@@ -115,7 +333,6 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     if (ritsuko::hdf5::exceeds_integer_limit(id_handle, 64, false)) {
         throw std::runtime_error("expected 'sequence' to have a datatype that fits into a 64-bit unsigned integer");
     }
-    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> id_stream(&id_handle, num_ranges, options.hdf5_buffer_size);
 
     auto start_handle = ritsuko::hdf5::open_dataset(ghandle, "start");
     if (num_ranges != ritsuko::hdf5::get_1d_length(start_handle, false)) {
@@ -124,7 +341,6 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     if (ritsuko::hdf5::exceeds_integer_limit(start_handle, 64, true)) {
         throw std::runtime_error("expected 'start' to have a datatype that fits into a 64-bit signed integer");
     }
-    ritsuko::hdf5::Stream1dNumericDataset<int64_t> start_stream(&start_handle, num_ranges, options.hdf5_buffer_size);
 
     auto width_handle = ritsuko::hdf5::open_dataset(ghandle, "width");
     if (num_ranges != ritsuko::hdf5::get_1d_length(width_handle, false)) {
@@ -133,76 +349,58 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     if (ritsuko::hdf5::exceeds_integer_limit(width_handle, 64, false)) {
         throw std::runtime_error("expected 'width' to have a datatype that fits into a 64-bit unsigned integer");
     }
-    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> width_stream(&width_handle, num_ranges, options.hdf5_buffer_size);
-
-    constexpr uint64_t end_limit = std::numeric_limits<int64_t>::max();
-    for (size_t i = 0; i < num_ranges; ++i, id_stream.next(), start_stream.next(), width_stream.next()) {
-        auto id = id_stream.get();
-        if (id >= num_sequences) {
-            throw std::runtime_error("'sequence' must be less than the number of sequences (got " + std::to_string(id) + ")");
-        }
-
-        auto start = start_stream.get();
-        auto width = width_stream.get();
-
-        // If it's definitely non-circular, the start position should be positive.
-        if (limits.has_circular[id] && !limits.circular[id]) {
-            if (start < 1) {
-                throw std::runtime_error("non-positive start position (" + std::to_string(start) + ") for non-circular sequence");
-            }
-
-            if (limits.has_seqlen[id]) {
-                // If the sequence length is provided, the end position shouldn't overflow.
-                auto spos = static_cast<uint64_t>(start);
-                auto limit = limits.seqlen[id];
-                if (spos > limit) {
-                    throw std::runtime_error("start position beyond sequence length (" + std::to_string(start) + " > " + std::to_string(limit) + ") for non-circular sequence");
-                }
-
-                // The LHS should not overflow as 'spos >= 1' so 'limit - spos + 1' should still be no greater than 'limit'.
-                if (limit - spos + 1 < width) {
-                    throw std::runtime_error("end position beyond sequence length (" + 
-                        std::to_string(start) + " + " + std::to_string(width) + " > " + std::to_string(limit) + 
-                        ") for non-circular sequence");
-                }
-            }
-        }
-
-        bool exceeded = false;
-        if (start > 0) {
-            // 'end_limit - start' is always non-negative as 'end_limit' is the largest value of an int64_t and 'start' is also int64_t.
-            exceeded = (end_limit - static_cast<uint64_t>(start) < width);
-        } else {
-            // 'end_limit - start' will not overflow a uint64_t, because 'end_limit' is the largest value of an int64_t and 'start' as also 'int64_t'.
-            exceeded = (end_limit + static_cast<uint64_t>(-start) < width);
-        }
-        if (exceeded) {
-            throw std::runtime_error("end position beyond the range of a 64-bit integer (" + std::to_string(start) + " + " + std::to_string(width) + ")");
-        }
-    }
 
-    {       
-        auto strand_handle = ritsuko::hdf5::open_dataset(ghandle, "strand");
-        if (num_ranges != ritsuko::hdf5::get_1d_length(strand_handle, false)) {
+    // Problems with 'strand' are only reported after all other errors, for consistency with a separate pass over the strands.
+    std::exception_ptr strand_error;
+    std::optional<H5::DataSet> strand_handle;
+    try {
+        strand_handle = ritsuko::hdf5::open_dataset(ghandle, "strand");
+        if (num_ranges != ritsuko::hdf5::get_1d_length(*strand_handle, false)) {
             throw std::runtime_error("'strand' and 'sequence' should have the same length");
         }
-        if (ritsuko::hdf5::exceeds_integer_limit(strand_handle, 32, true)) {
+        if (ritsuko::hdf5::exceeds_integer_limit(*strand_handle, 32, true)) {
             throw std::runtime_error("expected 'strand' to have a datatype that fits into a 32-bit signed integer");
         }
+    } catch (...) {
+        strand_error = std::current_exception();
+        strand_handle.reset();
+    }
 
-        ritsuko::hdf5::Stream1dNumericDataset<int32_t> strand_stream(&strand_handle, num_ranges, options.hdf5_buffer_size);
-        for (hsize_t i = 0; i < num_ranges; ++i, strand_stream.next()) {
-            auto x = strand_stream.get();
-            if (x < -1 || x > 1) {
-                throw std::runtime_error("values of 'strand' should be one of 0, -1, or 1 (got " + std::to_string(x) + ")");
+    // Sequence IDs and strands are read at their native width, as these are usually small integers.
+    internal_hdf5::dispatch_integer_type<uint64_t>(id_handle, [&](auto id_tag) -> void {
+        typedef decltype(id_tag) Id_;
+
+        auto run = [&](auto strand_tag) -> void {
+            typedef decltype(strand_tag) Strand_;
+            auto bad_strand = internal::validate_ranges<Id_, Strand_>(
+                id_handle,
+                start_handle,
+                width_handle,
+                (strand_handle.has_value() ? &(*strand_handle) : NULL),
+                num_ranges,
+                limits,
+                options
+            );
+
+            if (strand_error) {
+                std::rethrow_exception(strand_error);
             }
+            if (bad_strand.has_value()) {
+                throw std::runtime_error("values of 'strand' should be one of 0, -1, or 1 (got " + std::to_string(*bad_strand) + ")");
+            }
+        };
+
+        if (strand_handle.has_value()) {
+            internal_hdf5::dispatch_integer_type<int32_t>(*strand_handle, run);
+        } else {
+            run(int32_t());
         }
-    }
+    });
 
     internal_other::validate_mcols(path, "range_annotations", num_ranges, options);
     internal_other::validate_metadata(path, "other_annotations", options);
 
-    internal_string::validate_names(ghandle, "name", num_ranges, options.hdf5_buffer_size);
+    internal_string::validate_names(ghandle, "name", num_ranges, options.hdf5_buffer_size, options.validate_utf8);
 }
 
 /**
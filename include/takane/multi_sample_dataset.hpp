@@ -5,10 +5,17 @@
 #include <string>
 #include <cstdint>
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <optional>
+#include <memory>
 
 #include "utils_public.hpp"
 #include "utils_other.hpp"
 #include "utils_summarized_experiment.hpp"
+#include "utils_hdf5.hpp"
+#include "utils_simd.hpp"
+#include "utils_parallel.hpp"
 
 /**
  * @file multi_sample_dataset.hpp
@@ -33,6 +40,51 @@ bool satisfies_interface(const std::string&, const std::string&, const Options&)
  */
 namespace multi_sample_dataset {
 
+/**
+ * @cond
+ */
+namespace internal {
+
+inline void validate_sample_map(const H5::Group& ghandle, const std::string& ename, size_t num_columns, size_t num_samples, const Options& options) {
+    auto dhandle = ritsuko::hdf5::open_dataset(ghandle, ename.c_str());
+    if (ritsuko::hdf5::exceeds_integer_limit(dhandle, 64, false)) {
+        throw std::runtime_error("'multi_sample_dataset/" + ename + "' should have a datatype that fits into a 64-bit unsigned integer");
+    }
+
+    auto len = ritsuko::hdf5::get_1d_length(dhandle.getSpace(), false);
+    if (len != num_columns) {
+        throw std::runtime_error("length of 'multi_sample_dataset/" + ename + "' should equal the number of columns of 'experiments/" + ename + "'");
+    }
+
+    // Only the largest index needs to be compared to the number of samples.
+    auto instructions = internal_simd::available_instructions();
+    auto largest = internal_hdf5::dispatch_integer_type<uint64_t>(dhandle, [&](auto tag) -> uint64_t {
+        typedef decltype(tag) Type_;
+        return internal_hdf5::reduce_1d_blocks<Type_>(
+            dhandle,
+            len,
+            options.hdf5_buffer_size,
+            options.num_threads,
+            options.hdf5_memory_map,
+            static_cast<uint64_t>(0),
+            [&](uint64_t current, hsize_t, hsize_t count, const Type_* indices) -> uint64_t {
+                return std::max(current, static_cast<uint64_t>(internal_simd::masked_max<Type_>(indices, count, 0, instructions)));
+            },
+            [](uint64_t left, uint64_t right) -> uint64_t {
+                return std::max(left, right);
+            }
+        );
+    });
+    if (len && largest >= num_samples) {
+        throw std::runtime_error("indices in 'multi_sample_dataset/" + ename + "' should be less than the number of samples");
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
 /**
  * @param path Path to the directory containing the multi-sample dataset.
  * @param metadata Metadata for the object, typically read from its `OBJECT` file.
@@ -62,70 +114,76 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     }
     size_t num_samples = ::takane::height(sd_path, sdmeta, options);
 
-    // Checking the experiments.
-    std::vector<size_t> num_columns;
+    // Checking the experiments, along with the sample map for each experiment.
     auto edir = path / "experiments";
     if (std::filesystem::exists(edir)) {
         size_t num_experiments = internal_summarized_experiment::check_names_json(edir);
-        num_columns.reserve(num_experiments);
 
-        for (size_t e = 0; e < num_experiments; ++e) {
+        // Errors in the sample map are deferred until all experiments are
+        // validated, so that we report the same error as if we checked all
+        // experiments before the sample map.
+        std::optional<H5::H5File> smhandle;
+        std::optional<H5::Group> smghandle;
+        std::optional<std::string> open_error;
+        if (num_experiments > 0) {
+            try {
+                smhandle = ritsuko::hdf5::open_file(path / "sample_map.h5");
+                smghandle = ritsuko::hdf5::open_group(*smhandle, type_name.c_str());
+            } catch (std::exception& e) {
+                open_error = e.what();
+            }
+        }
+        std::vector<std::optional<std::string> > sample_map_errors(num_experiments);
+
+        auto validate_experiment = [&](size_t e, Options& experiment_options) -> void {
             auto ename = std::to_string(e);
             auto epath = edir / ename;
             auto emeta = read_object_metadata(epath);
 
-            if (!satisfies_interface(emeta.type, "SUMMARIZED_EXPERIMENT", options)) {
+            if (!satisfies_interface(emeta.type, "SUMMARIZED_EXPERIMENT", experiment_options)) {
                 throw std::runtime_error("object in 'experiments/" + ename + "' should satisfy the 'SUMMARIZED_EXPERIMENT' interface");
             }
 
             try {
-                ::takane::validate(epath, emeta, options);
-            } catch (std::exception& e) {
-                throw std::runtime_error("failed to validate 'experiments/" + ename + "'; " + std::string(e.what()));
+                ::takane::validate(epath, emeta, experiment_options);
+            } catch (std::exception& err) {
+                throw std::runtime_error("failed to validate 'experiments/" + ename + "'; " + std::string(err.what()));
             }
 
-            auto dims = ::takane::dimensions(epath, emeta, options);
-            num_columns.push_back(dims[1]);
-        }
+            if (smghandle.has_value()) {
+                auto dims = ::takane::dimensions(epath, emeta, experiment_options);
+                try {
+                    internal::validate_sample_map(*smghandle, ename, dims[1], num_samples, experiment_options);
+                } catch (std::exception& err) {
+                    sample_map_errors[e] = err.what();
+                }
+            }
+        };
+
+        // Experiments may be validated in parallel, see Options::num_threads.
+        internal_parallel::parallelize_objects(num_experiments, options, validate_experiment);
 
         size_t num_dir_obj = internal_other::count_directory_entries(edir);
         if (num_dir_obj - 1 != num_experiments) { // -1 to account for the names.json file itself.
             throw std::runtime_error("more objects than expected inside the 'experiments' subdirectory");
         }
-    }
-
-    // Checking the sample map.
-    if (num_columns.size() > 0) {
-        try {
-            auto handle = ritsuko::hdf5::open_file(path / "sample_map.h5");
-            auto ghandle = ritsuko::hdf5::open_group(handle, type_name.c_str());
-
-            for (size_t e = 0, end = num_columns.size(); e < end; ++e) {
-                auto ename = std::to_string(e);
-                auto dhandle = ritsuko::hdf5::open_dataset(ghandle, ename.c_str());
-                if (ritsuko::hdf5::exceeds_integer_limit(dhandle, 64, false)) {
-                    throw std::runtime_error("'multi_sample_dataset/" + ename + "' should have a datatype that fits into a 64-bit unsigned integer");
-                }
 
-                auto len = ritsuko::hdf5::get_1d_length(dhandle.getSpace(), false);
-                if (len != num_columns[e]) {
-                    throw std::runtime_error("length of 'multi_sample_dataset/" + ename + "' should equal the number of columns of 'experiments/" + ename + "'");
+        if (num_experiments > 0) {
+            try {
+                if (open_error.has_value()) {
+                    throw std::runtime_error(*open_error);
                 }
-
-                ritsuko::hdf5::Stream1dNumericDataset<uint64_t> stream(&dhandle, len, options.hdf5_buffer_size);
-                for (hsize_t i = 0; i < len; ++i, stream.next()) {
-                    auto x = stream.get();
-                    if (static_cast<size_t>(x) >= num_samples) {
-                        throw std::runtime_error("indices in 'multi_sample_dataset/" + ename + "' should be less than the number of samples");
+                for (const auto& err : sample_map_errors) {
+                    if (err.has_value()) {
+                        throw std::runtime_error(*err);
                     }
                 }
+                if (num_experiments != smghandle->getNumObjs()) {
+                    throw std::runtime_error("more objects present in the 'multi_sample_dataset' group than expected");
+                }
+            } catch (std::exception& e) {
+                throw std::runtime_error("failed to validate the sample mapping; " + std::string(e.what()));
             }
-
-            if (num_columns.size() != ghandle.getNumObjs()) {
-                throw std::runtime_error("more objects present in the 'multi_sample_dataset' group than expected");
-            }
-        } catch (std::exception& e) {
-            throw std::runtime_error("failed to validate the sample mapping; " + std::string(e.what()));
         }
     }
 
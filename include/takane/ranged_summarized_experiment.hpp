@@ -33,39 +33,61 @@ bool derived_from(const std::string&, const std::string&, const Options&);
 namespace ranged_summarized_experiment {
 
 /**
- * @param path Path to the directory containing the ranged summarized experiment.
- * @param metadata Metadata for the object, typically read from its `OBJECT` file.
- * @param options Validation options.
+ * @cond
  */
-inline void validate(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
-    ::takane::summarized_experiment::validate(path, metadata, options);
+namespace internal {
 
-    const std::string type_name = "ranged_summarized_experiment"; // use a separate variable to avoid dangling reference warnings from GCC.
-    const auto& rsemap = internal_json::extract_typed_object_from_metadata(metadata.other, type_name);
+inline void add_tasks(const std::filesystem::path& path, const ObjectMetadata& metadata, internal_summarized_experiment::ComponentTasks& tasks) {
+    ::takane::summarized_experiment::internal::add_tasks(path, metadata, tasks);
 
-    const std::string version_name = "version"; // again, avoid dangling reference warnings.
-    const std::string& vstring = internal_json::extract_string_from_typed_object(rsemap, version_name, type_name);
-    auto version = ritsuko::parse_version_string(vstring.c_str(), vstring.size(), /* skip_patch = */ true);
-    if (version.major != 1) {
-        throw std::runtime_error("unsupported version string '" + vstring + "'");
-    }
+    tasks.plan([&]() -> void {
+        const std::string type_name = "ranged_summarized_experiment"; // use a separate variable to avoid dangling reference warnings from GCC.
+        const auto& rsemap = internal_json::extract_typed_object_from_metadata(metadata.other, type_name);
 
-    auto rangedir = path / "row_ranges";
-    if (std::filesystem::exists(rangedir)) {
-        auto rangemeta = read_object_metadata(rangedir);
-        if (!derived_from(rangemeta.type, "genomic_ranges", options) && !derived_from(rangemeta.type, "genomic_ranges_list", options)) {
-            throw std::runtime_error("object in 'row_ranges' must be a 'genomic_ranges' or 'genomic_ranges_list'");
+        const std::string version_name = "version"; // again, avoid dangling reference warnings.
+        const std::string& vstring = internal_json::extract_string_from_typed_object(rsemap, version_name, type_name);
+        auto version = ritsuko::parse_version_string(vstring.c_str(), vstring.size(), /* skip_patch = */ true);
+        if (version.major != 1) {
+            throw std::runtime_error("unsupported version string '" + vstring + "'");
         }
+    });
 
-        ::takane::validate(rangedir, rangemeta, options);
-
-        auto num_row = ::takane::summarized_experiment::height(path, metadata, options);
-        if (::takane::height(rangedir, rangemeta, options) != num_row) {
-            throw std::runtime_error("object in 'row_ranges' must have length equal to the number of rows of its parent '" + metadata.type + "'");
-        }
+    auto rangedir = path / "row_ranges";
+    if (!tasks.failed() && std::filesystem::exists(rangedir)) {
+        tasks.add([&path, &metadata, rangedir](Options& options) -> void {
+            auto rangemeta = read_object_metadata(rangedir);
+            if (!derived_from(rangemeta.type, "genomic_ranges", options) && !derived_from(rangemeta.type, "genomic_ranges_list", options)) {
+                throw std::runtime_error("object in 'row_ranges' must be a 'genomic_ranges' or 'genomic_ranges_list'");
+            }
+
+            ::takane::validate(rangedir, rangemeta, options);
+
+            auto num_row = ::takane::summarized_experiment::height(path, metadata, options);
+            if (::takane::height(rangedir, rangemeta, options) != num_row) {
+                throw std::runtime_error("object in 'row_ranges' must have length equal to the number of rows of its parent '" + metadata.type + "'");
+            }
+        });
     }
 }
 
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @param path Path to the directory containing the ranged summarized experiment.
+ * @param metadata Metadata for the object, typically read from its `OBJECT` file.
+ * @param options Validation options.
+ *
+ * If `Options::parallel_objects` is enabled, the row ranges are validated in parallel with the components of the base summarized experiment.
+ */
+inline void validate(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
+    internal_summarized_experiment::ComponentTasks tasks;
+    internal::add_tasks(path, metadata, tasks);
+    tasks.run(options);
+}
+
 }
 
 }
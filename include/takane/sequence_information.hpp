@@ -6,11 +6,14 @@
 
 #include <filesystem>
 #include <stdexcept>
-#include <unordered_set>
 #include <string>
+#include <string_view>
+#include <algorithm>
 
 #include "utils_public.hpp"
 #include "utils_json.hpp"
+#include "utils_hash.hpp"
+#include "utils_hdf5.hpp"
 
 /**
  * @file sequence_information.hpp
@@ -49,15 +52,13 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         }
 
         nseq = ritsuko::hdf5::get_1d_length(nhandle.getSpace(), false);
-        std::unordered_set<std::string> collected;
-        ritsuko::hdf5::Stream1dStringDataset stream(&nhandle, nseq, options.hdf5_buffer_size);
-        for (size_t s = 0; s < nseq; ++s, stream.next()) {
-            auto x = stream.steal();
-            if (collected.find(x) != collected.end()) {
-                throw std::runtime_error("detected duplicated sequence name '" + x + "'");
+        internal_hash::StringSet collected;
+        collected.reserve(std::min<hsize_t>(nseq, internal_hash::StringSet::max_reserve()));
+        internal_hdf5::iterate_1d_strings(nhandle, nseq, options.hdf5_buffer_size, [&](hsize_t, std::string_view x) -> void {
+            if (!collected.insert(x)) {
+                throw std::runtime_error("detected duplicated sequence name '" + std::string(x) + "'");
             }
-            collected.insert(std::move(x));
-        }
+        }, options.validate_utf8);
     }
 
     const char* missing_attr_name = "missing-value-placeholder";
@@ -98,6 +99,9 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
         if (ritsuko::hdf5::get_1d_length(gnhandle.getSpace(), false) != nseq) {
             throw std::runtime_error("expected lengths of 'length' and 'genome' to be equal");
         }
+        if (options.validate_utf8) {
+            internal_hdf5::validate_1d_strings(gnhandle, nseq, options.hdf5_buffer_size, /* check_utf8 = */ true);
+        }
         if (gnhandle.attrExists(missing_attr_name)) {
             auto ahandle = gnhandle.openAttribute(missing_attr_name);
             ritsuko::hdf5::check_string_missing_placeholder_attribute(ahandle);
@@ -9,13 +9,16 @@
 #include "utils_public.hpp"
 #include "utils_other.hpp"
 #include "utils_files.hpp"
+#include "utils_hash.hpp"
+#include "utils_hdf5.hpp"
+#include "utils_parallel.hpp"
 
 #include <filesystem>
 #include <stdexcept>
-#include <unordered_set>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 /**
  * @file spatial_experiment.hpp
@@ -118,8 +121,8 @@ inline void validate_images(const std::filesystem::path& path, size_t ncols, Opt
             static std::string codes() { return "sample assignments"; }
         };
 
-        auto num_samples = internal_factor::validate_factor_levels<SampleMapMessenger>(ghandle, "sample_names", options.hdf5_buffer_size);
-        auto num_codes = internal_factor::validate_factor_codes<SampleMapMessenger>(ghandle, "column_samples", num_samples, options.hdf5_buffer_size, true);
+        auto num_samples = internal_factor::validate_factor_levels<SampleMapMessenger>(ghandle, "sample_names", options.hdf5_buffer_size, options.validate_utf8);
+        auto num_codes = internal_factor::validate_factor_codes<SampleMapMessenger>(ghandle, "column_samples", num_samples, options.hdf5_buffer_size, true, options.hdf5_memory_map);
         if (num_codes != ncols) {
             throw std::runtime_error("length of 'column_samples' should equal the number of columns in the spatial experiment");
         }
@@ -138,6 +141,9 @@ inline void validate_images(const std::filesystem::path& path, size_t ncols, Opt
         if (ritsuko::hdf5::get_1d_length(id_handle.getSpace(), false) != num_images) {
             throw std::runtime_error("expected 'image_ids' to have the same length as 'image_samples'");
         }
+        if (options.validate_utf8) {
+            internal_hdf5::validate_1d_strings(id_handle, num_images, options.hdf5_buffer_size, /* check_utf8 = */ true);
+        }
 
         auto scale_handle = ritsuko::hdf5::open_dataset(ghandle, "image_scale_factors");
         if (ritsuko::hdf5::exceeds_float_limit(scale_handle, 64)) {
@@ -147,31 +153,42 @@ inline void validate_images(const std::filesystem::path& path, size_t ncols, Opt
             throw std::runtime_error("expected 'image_scale_factors' to have the same length as 'image_samples'");
         }
 
-        ritsuko::hdf5::Stream1dNumericDataset<uint64_t> sample_stream(&sample_handle, num_images, options.hdf5_buffer_size);
+        // The numeric columns are read together for each block.
         ritsuko::hdf5::Stream1dStringDataset id_stream(&id_handle, num_images, options.hdf5_buffer_size);
-        ritsuko::hdf5::Stream1dNumericDataset<double> scale_stream(&scale_handle, num_images, options.hdf5_buffer_size);
-        std::vector<std::unordered_set<std::string> > collected(num_samples);
+        hsize_t block_size = std::max(options.hdf5_buffer_size, static_cast<hsize_t>(1));
+        std::vector<uint64_t> sample_buffer;
+        std::vector<double> scale_buffer;
+        internal_hdf5::MultiRead batch;
+        std::vector<internal_hash::StringSet> collected(num_samples);
 
         for (hsize_t i = 0; i < num_images; ++i) {
-            auto sample = sample_stream.get();
+            hsize_t offset = i % block_size;
+            if (offset == 0) {
+                hsize_t count = std::min(block_size, num_images - i);
+                sample_buffer.resize(count);
+                scale_buffer.resize(count);
+                batch.clear();
+                batch.add(sample_handle, sample_buffer.data());
+                batch.add(scale_handle, scale_buffer.data());
+                batch.run(i, count, num_images);
+            }
+
+            auto sample = sample_buffer[offset];
             if (sample >= num_samples) {
                 throw std::runtime_error("entries of 'image_samples' should be less than the number of samples");
             }
-            sample_stream.next();
 
             auto& present = collected[sample];
             auto id = id_stream.steal();
-            if (present.find(id) != present.end()) {
+            if (!present.insert(id)) {
                 throw std::runtime_error("'image_ids' contains duplicated image IDs for the same sample + ('" + id + "')");
             }
-            present.insert(std::move(id));
             id_stream.next();
 
-            auto sc = scale_stream.get();
+            auto sc = scale_buffer[offset];
             if (!std::isfinite(sc) || sc <= 0) {
                 throw std::runtime_error("entries of 'image_scale_factors' should be finite and positive");
             }
-            scale_stream.next();
         }
 
         if (version.ge(1, 3, 0) && !ghandle.exists("image_formats")) { 
@@ -185,6 +202,9 @@ inline void validate_images(const std::filesystem::path& path, size_t ncols, Opt
             if (ritsuko::hdf5::get_1d_length(format_handle.getSpace(), false) != num_images) {
                 throw std::runtime_error("expected 'image_formats' to have the same length as 'image_samples'");
             }
+            if (options.validate_utf8) {
+                internal_hdf5::validate_1d_strings(format_handle, num_images, options.hdf5_buffer_size, /* check_utf8 = */ true);
+            }
             image_formats.reserve(num_images);
 
             ritsuko::hdf5::Stream1dStringDataset format_stream(&format_handle, num_images, options.hdf5_buffer_size);
@@ -206,10 +226,21 @@ inline void validate_images(const std::filesystem::path& path, size_t ncols, Opt
         throw std::runtime_error("failed to validate '" + mappath.string() + "'; " + std::string(e.what()));
     }
 
-    // Now validating the images themselves. 
+    // Now validating the images themselves. PNG and TIFF images only involve
+    // a signature probe without any HDF5 calls or custom functions, so these
+    // can always be checked concurrently; other images require full object
+    // validation and are subject to the usual restrictions on parallelism.
     size_t num_images = image_formats.size();
-    for (size_t i = 0; i < num_images; ++i) {
-        validate_image(image_dir, i, image_formats[i], options, version);
+    bool has_other = std::find(image_formats.begin(), image_formats.end(), "OTHER") != image_formats.end();
+
+    if (has_other) {
+        internal_parallel::parallelize_objects(num_images, options, [&](size_t i, Options& image_options) -> void {
+            validate_image(image_dir, i, image_formats[i], image_options, version);
+        });
+    } else {
+        internal_parallel::parallelize(num_images, options.num_threads, [&](size_t i) -> void {
+            validate_image(image_dir, i, image_formats[i], options, version);
+        });
     }
 
     size_t num_dir_obj = internal_other::count_directory_entries(image_dir);
@@ -227,20 +258,36 @@ inline void validate_images(const std::filesystem::path& path, size_t ncols, Opt
  * @param path Path to the directory containing the spatial experiment.
  * @param metadata Metadata for the object, typically read from its `OBJECT` file.
  * @param options Validation options.
+ *
+ * If `Options::parallel_objects` is enabled, the coordinates and images are validated in parallel with the components of the base single cell experiment.
+ * PNG and TIFF images are checked in parallel if `Options::num_threads` is greater than 1, regardless of `Options::parallel_objects`.
  */
 inline void validate(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
-    ::takane::single_cell_experiment::validate(path, metadata, options);
+    internal_summarized_experiment::ComponentTasks tasks;
+    ::takane::single_cell_experiment::internal::add_tasks(path, metadata, options, tasks);
+
+    ritsuko::Version version;
+    size_t num_cols = 0;
+    tasks.plan([&]() -> void {
+        const std::string type_name = "spatial_experiment"; // use a separate variable to avoid dangling reference warnings from GCC.
+        const std::string& vstring = internal_json::extract_version_for_type(metadata.other, type_name);
+        version = ritsuko::parse_version_string(vstring.c_str(), vstring.size(), /* skip_patch = */ true);
+        if (version.major != 1) {
+            throw std::runtime_error("unsupported version string '" + vstring + "'");
+        }
 
-    const std::string type_name = "spatial_experiment"; // use a separate variable to avoid dangling reference warnings from GCC.
-    const std::string& vstring = internal_json::extract_version_for_type(metadata.other, type_name);
-    auto version = ritsuko::parse_version_string(vstring.c_str(), vstring.size(), /* skip_patch = */ true);
-    if (version.major != 1) {
-        throw std::runtime_error("unsupported version string '" + vstring + "'");
-    }
+        auto dims = ::takane::summarized_experiment::dimensions(path, metadata, options);
+        num_cols = dims[1];
+    });
+
+    tasks.add([&path, num_cols](Options& options) -> void {
+        internal::validate_coordinates(path, num_cols, options);
+    });
+    tasks.add([&path, num_cols, version](Options& options) -> void {
+        internal::validate_images(path, num_cols, options, version);
+    });
 
-    auto dims = ::takane::summarized_experiment::dimensions(path, metadata, options);
-    internal::validate_coordinates(path, dims[1], options);
-    internal::validate_images(path, dims[1], options, version);
+    tasks.run(options);
 }
 
 }
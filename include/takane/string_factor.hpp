@@ -41,10 +41,10 @@ inline void validate(const std::filesystem::path& path, const ObjectMetadata& me
     auto ghandle = ritsuko::hdf5::open_group(handle, type_name.c_str());
     internal_factor::check_ordered_attribute(ghandle);
 
-    size_t num_levels = internal_factor::validate_factor_levels(ghandle, "levels", options.hdf5_buffer_size);
-    size_t num_codes = internal_factor::validate_factor_codes(ghandle, "codes", num_levels, options.hdf5_buffer_size);
+    size_t num_levels = internal_factor::validate_factor_levels(ghandle, "levels", options.hdf5_buffer_size, options.validate_utf8);
+    size_t num_codes = internal_factor::validate_factor_codes(ghandle, "codes", num_levels, options.hdf5_buffer_size, /* allow_missing = */ true, options.hdf5_memory_map);
 
-    internal_string::validate_names(ghandle, "names", num_codes, options.hdf5_buffer_size);
+    internal_string::validate_names(ghandle, "names", num_codes, options.hdf5_buffer_size, options.validate_utf8);
 }
 
 /**
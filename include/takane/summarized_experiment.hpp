@@ -36,80 +36,117 @@ bool satisfies_interface(const std::string&, const std::string&, const Options&)
 namespace summarized_experiment {
 
 /**
- * @param path Path to the directory containing the summarized experiment.
- * @param metadata Metadata for the object, typically read from its `OBJECT` file.
- * @param options Validation options.
+ * @cond
  */
-inline void validate(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
-    const std::string type_name = "summarized_experiment"; // use a separate variable to avoid dangling reference warnings from GCC.
-    const auto& semap = internal_json::extract_typed_object_from_metadata(metadata.other, type_name);
-
-    const std::string version_name = "version"; // again, avoid dangling reference warnings.
-    const std::string& vstring = internal_json::extract_string_from_typed_object(semap, version_name, type_name);
-    auto version = ritsuko::parse_version_string(vstring.c_str(), vstring.size(), /* skip_patch = */ true);
-    if (version.major != 1) {
-        throw std::runtime_error("unsupported version string '" + vstring + "'");
-    }
+namespace internal {
+
+// Adds tasks for all components of the summarized experiment, which can be
+// extended by derived types before running them; see ComponentTasks.
+inline void add_tasks(const std::filesystem::path& path, const ObjectMetadata& metadata, internal_summarized_experiment::ComponentTasks& tasks) {
+    size_t num_rows = 0, num_cols = 0;
+    tasks.plan([&]() -> void {
+        const std::string type_name = "summarized_experiment"; // use a separate variable to avoid dangling reference warnings from GCC.
+        const auto& semap = internal_json::extract_typed_object_from_metadata(metadata.other, type_name);
+
+        const std::string version_name = "version"; // again, avoid dangling reference warnings.
+        const std::string& vstring = internal_json::extract_string_from_typed_object(semap, version_name, type_name);
+        auto version = ritsuko::parse_version_string(vstring.c_str(), vstring.size(), /* skip_patch = */ true);
+        if (version.major != 1) {
+            throw std::runtime_error("unsupported version string '" + vstring + "'");
+        }
 
-    // Validating the dimensions.
-    auto dims = internal_summarized_experiment::extract_dimensions_json(semap, type_name);
-    size_t num_rows = dims.first;
-    size_t num_cols = dims.second;
+        // Validating the dimensions.
+        auto dims = internal_summarized_experiment::extract_dimensions_json(semap, type_name);
+        num_rows = dims.first;
+        num_cols = dims.second;
+    });
 
     // Checking the assays. The directory is also allowed to not exist, 
     // in which case we have no assays.
     auto adir = path / "assays";
-    if (std::filesystem::exists(adir)) {
-        size_t num_assays = internal_summarized_experiment::check_names_json(adir);
+    if (!tasks.failed() && std::filesystem::exists(adir)) {
+        size_t num_assays = 0;
+        tasks.plan([&]() -> void {
+            num_assays = internal_summarized_experiment::check_names_json(adir);
+        });
+
         for (size_t i = 0; i < num_assays; ++i) {
-            auto aname = std::to_string(i);
-            auto apath = adir / aname;
-            auto ameta = read_object_metadata(apath);
-            ::takane::validate(apath, ameta, options);
-
-            auto dims = ::takane::dimensions(apath, ameta, options);
-            if (dims.size() < 2) {
-                throw std::runtime_error("object in 'assays/" + aname + "' should have two or more dimensions");
-            }
-            if (dims[0] != num_rows) {
-                throw std::runtime_error("object in 'assays/" + aname + "' should have the same number of rows as its parent '" + metadata.type + "'");
-            }
-            if (dims[1] != num_cols) {
-                throw std::runtime_error("object in 'assays/" + aname + "' should have the same number of columns as its parent '" + metadata.type + "'");
-            }
+            tasks.add([&metadata, adir, i, num_rows, num_cols](Options& options) -> void {
+                auto aname = std::to_string(i);
+                auto apath = adir / aname;
+                auto ameta = read_object_metadata(apath);
+                ::takane::validate(apath, ameta, options);
+
+                auto dims = ::takane::dimensions(apath, ameta, options);
+                if (dims.size() < 2) {
+                    throw std::runtime_error("object in 'assays/" + aname + "' should have two or more dimensions");
+                }
+                if (dims[0] != num_rows) {
+                    throw std::runtime_error("object in 'assays/" + aname + "' should have the same number of rows as its parent '" + metadata.type + "'");
+                }
+                if (dims[1] != num_cols) {
+                    throw std::runtime_error("object in 'assays/" + aname + "' should have the same number of columns as its parent '" + metadata.type + "'");
+                }
+            });
         }
 
-        size_t num_dir_obj = internal_other::count_directory_entries(adir);
-        if (num_dir_obj - 1 != num_assays) { // -1 to account for the names.json file itself.
-            throw std::runtime_error("more objects than expected inside the 'assays' subdirectory");
-        }
+        tasks.plan([&]() -> void {
+            size_t num_dir_obj = internal_other::count_directory_entries(adir);
+            if (num_dir_obj - 1 != num_assays) { // -1 to account for the names.json file itself.
+                throw std::runtime_error("more objects than expected inside the 'assays' subdirectory");
+            }
+        });
     }
 
     auto rd_path = path / "row_data";
-    if (std::filesystem::exists(rd_path)) {
-        auto rdmeta = read_object_metadata(rd_path);
-        if (!satisfies_interface(rdmeta.type, "DATA_FRAME", options)) {
-            throw std::runtime_error("object in 'row_data' should satisfy the 'DATA_FRAME' interface");
-        }
-        ::takane::validate(rd_path, rdmeta, options);
-        if (::takane::height(rd_path, rdmeta, options) != num_rows) {
-            throw std::runtime_error("data frame at 'row_data' should have number of rows equal to that of the '" + metadata.type + "'");
-        }
+    if (!tasks.failed() && std::filesystem::exists(rd_path)) {
+        tasks.add([&metadata, rd_path, num_rows](Options& options) -> void {
+            auto rdmeta = read_object_metadata(rd_path);
+            if (!satisfies_interface(rdmeta.type, "DATA_FRAME", options)) {
+                throw std::runtime_error("object in 'row_data' should satisfy the 'DATA_FRAME' interface");
+            }
+            ::takane::validate(rd_path, rdmeta, options);
+            if (::takane::height(rd_path, rdmeta, options) != num_rows) {
+                throw std::runtime_error("data frame at 'row_data' should have number of rows equal to that of the '" + metadata.type + "'");
+            }
+        });
     }
 
     auto cd_path = path / "column_data";
-    if (std::filesystem::exists(cd_path)) {
-        auto cdmeta = read_object_metadata(cd_path);
-        if (!satisfies_interface(cdmeta.type, "DATA_FRAME", options)) {
-            throw std::runtime_error("object in 'column_data' should satisfy the 'DATA_FRAME' interface");
-        }
-        ::takane::validate(cd_path, cdmeta, options);
-        if (::takane::height(cd_path, cdmeta, options) != num_cols) {
-            throw std::runtime_error("data frame at 'column_data' should have number of rows equal to the number of columns of its parent '" + metadata.type + "'");
-        }
+    if (!tasks.failed() && std::filesystem::exists(cd_path)) {
+        tasks.add([&metadata, cd_path, num_cols](Options& options) -> void {
+            auto cdmeta = read_object_metadata(cd_path);
+            if (!satisfies_interface(cdmeta.type, "DATA_FRAME", options)) {
+                throw std::runtime_error("object in 'column_data' should satisfy the 'DATA_FRAME' interface");
+            }
+            ::takane::validate(cd_path, cdmeta, options);
+            if (::takane::height(cd_path, cdmeta, options) != num_cols) {
+                throw std::runtime_error("data frame at 'column_data' should have number of rows equal to the number of columns of its parent '" + metadata.type + "'");
+            }
+        });
     }
 
-    internal_other::validate_metadata(path, "other_data", options);
+    tasks.add([path](Options& options) -> void {
+        internal_other::validate_metadata(path, "other_data", options);
+    });
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @param path Path to the directory containing the summarized experiment.
+ * @param metadata Metadata for the object, typically read from its `OBJECT` file.
+ * @param options Validation options.
+ *
+ * If `Options::parallel_objects` is enabled, the assays, row data, column data and other data are validated in parallel.
+ */
+inline void validate(const std::filesystem::path& path, const ObjectMetadata& metadata, Options& options) {
+    internal_summarized_experiment::ComponentTasks tasks;
+    internal::add_tasks(path, metadata, tasks);
+    tasks.run(options);
 }
 
 /**
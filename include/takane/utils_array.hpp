@@ -5,6 +5,7 @@
 #include "ritsuko/hdf5/hdf5.hpp"
 #include "ritsuko/ritsuko.hpp"
 #include "utils_public.hpp"
+#include "utils_hdf5.hpp"
 
 #include <string>
 #include <vector>
@@ -22,13 +23,15 @@ void check_dimnames(const H5::Group& handle, const std::string& name, const std:
     auto nhandle = handle.openGroup(name);
 
     size_t found = 0;
-    for (size_t d = 0, ndim = dimensions.size(); d < ndim; ++d) {
-        std::string dname = std::to_string(d);
-        if (!nhandle.exists(dname)) {
+    size_t ndim = dimensions.size();
+    internal_hdf5::IndexedChildren children(nhandle, ndim);
+    for (size_t d = 0; d < ndim; ++d) {
+        if (!children.exists(d)) {
             continue;
         }
+        std::string dname = std::to_string(d);
 
-        if (nhandle.childObjType(dname) != H5O_TYPE_DATASET) {
+        if (children.type(d) != H5O_TYPE_DATASET) {
             throw std::runtime_error("expected '" + name + "/" + dname + "' to be a dataset");
         }
         auto dhandle = nhandle.openDataSet(dname);
@@ -44,11 +47,11 @@ void check_dimnames(const H5::Group& handle, const std::string& name, const std:
             throw std::runtime_error("expected '" + name + "/" + dname + "' to have a datatype that can be represented by a UTF-8 encoded string");
         }
 
-        ritsuko::hdf5::validate_1d_string_dataset(dhandle, len, options.hdf5_buffer_size);
+        internal_hdf5::validate_1d_strings(dhandle, len, options.hdf5_buffer_size, options.validate_utf8);
         ++found;
     }
 
-    if (found != nhandle.getNumObjs()) {
+    if (found != children.size()) {
         throw std::runtime_error("more objects present in the '" + name + "' group than expected");
     }
 
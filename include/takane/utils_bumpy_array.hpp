@@ -11,11 +11,16 @@
 #include <vector>
 #include <array>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <algorithm>
 
 #include "utils_public.hpp"
 #include "utils_array.hpp"
 #include "utils_other.hpp"
 #include "utils_json.hpp"
+#include "utils_hdf5.hpp"
+#include "utils_parallel.hpp"
 
 namespace takane {
 
@@ -37,7 +42,7 @@ inline std::vector<uint64_t> validate_dimensions(const H5::Group& handle) {
     return output;
 }
 
-inline hsize_t validate_lengths(const H5::Group& handle, size_t concatenated_length, hsize_t buffer_size) {
+inline hsize_t validate_lengths(const H5::Group& handle, size_t concatenated_length, hsize_t buffer_size, int num_threads = 1, bool memory_map = true) {
     auto lhandle = ritsuko::hdf5::open_dataset(handle, "lengths");
     if (ritsuko::hdf5::exceeds_integer_limit(lhandle, 64, false)) {
         throw std::runtime_error("expected 'lengths' to have a datatype that fits in a 64-bit unsigned integer");
@@ -45,19 +50,57 @@ inline hsize_t validate_lengths(const H5::Group& handle, size_t concatenated_len
 
     auto len = ritsuko::hdf5::get_1d_length(lhandle.getSpace(), false);
 
-    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> stream(&lhandle, len, buffer_size);
-    size_t total = 0;
-    for (size_t i = 0; i < len; ++i, stream.next()) {
-        total += stream.get();
+    auto total = internal_hdf5::sum_1d_integers(lhandle, len, buffer_size, num_threads, memory_map);
+    if (!total.has_value()) {
+        throw std::runtime_error("sum of 'lengths' does not fit in a 64-bit unsigned integer");
     }
-    if (total != concatenated_length) {
-        throw std::runtime_error("sum of 'lengths' does not equal the height of the concatenated object (got " + std::to_string(total) + ", expected " + std::to_string(concatenated_length) + ")");
+    if (*total != concatenated_length) {
+        throw std::runtime_error("sum of 'lengths' does not equal the height of the concatenated object (got " + std::to_string(*total) + ", expected " + std::to_string(concatenated_length) + ")");
     }
 
     return len;
 }
 
-inline void validate_sparse_indices(const H5::Group& handle, const std::vector<uint64_t>& dimensions, hsize_t num_lengths, hsize_t buffer_size) {
+// Original element-wise checks for the coordinate at 'j' in 'columns', which
+// is used to report the first error in a block that failed the fast checks.
+inline void check_sparse_coordinate(const std::vector<const uint64_t*>& columns, hsize_t j, bool has_previous, const std::vector<uint64_t>& dimensions) {
+    size_t ndims = dimensions.size();
+    if (!has_previous) {
+        for (size_t d = 0; d < ndims; ++d) {
+            if (columns[d][j] >= dimensions[d]) {
+                throw std::runtime_error("values in 'indices/" + std::to_string(d) + "' should be less than the corresponding dimension extent");
+            }
+        }
+        return;
+    }
+
+    bool greater = false;
+
+    // Going from back to front and checking for increasingness, based on the
+    // expectation that the first dimension is the fastest-changing.
+    for (size_t rd = ndims; rd > 0; --rd) {
+        auto d = rd - 1;
+        auto nextv = columns[d][j];
+        if (nextv >= dimensions[d]) {
+            throw std::runtime_error("values in 'indices/" + std::to_string(d) + "' should be less than the corresponding dimension extent");
+        }
+
+        auto oldv = columns[d][j - 1];
+        if (!greater) {
+            if (nextv > oldv) {
+                greater = true;
+            } else if (nextv < oldv) {
+                throw std::runtime_error("coordinates in 'indices' should be strictly increasing");
+            }
+        }
+    }
+
+    if (!greater) {
+        throw std::runtime_error("duplicate coordinates in 'indices'");
+    }
+}
+
+inline void validate_sparse_indices(const H5::Group& handle, const std::vector<uint64_t>& dimensions, hsize_t num_lengths, hsize_t buffer_size, int num_threads = 1, bool memory_map = true) {
     size_t ndims = dimensions.size();
     std::vector<H5::DataSet> handles;
     handles.reserve(ndims);
@@ -79,50 +122,76 @@ inline void validate_sparse_indices(const H5::Group& handle, const std::vector<u
         return;
     }
 
-    std::vector<ritsuko::hdf5::Stream1dNumericDataset<uint64_t> > streams;
-    streams.reserve(ndims);
-    std::vector<uint64_t> position;
-    position.reserve(ndims); 
-
+    std::mutex lock;
+    std::vector<std::unique_ptr<internal_hdf5::ConcurrentBlockReader<uint64_t> > > readers;
+    readers.reserve(ndims);
     for (size_t d = 0; d < ndims; ++d) {
-        streams.emplace_back(&(handles[d]), num_lengths, buffer_size);
-        position.push_back(streams.back().get());
-        if (position.back() >= dimensions[d]) {
-            throw std::runtime_error("values in 'indices/" + std::to_string(d) + "' should be less than the corresponding dimension extent");
-        }
-        streams.back().next();
+        readers.emplace_back(new internal_hdf5::ConcurrentBlockReader<uint64_t>(handles[d], num_lengths, memory_map, lock));
     }
 
-    for (size_t l = 1; l < num_lengths; ++l) {
-        bool greater = false;
-
-        // Going from back to front and checking for increasingness, based on the
-        // expectation that the first dimension is the fastest-changing.
-        for (size_t rd = ndims; rd > 0; --rd) {
-            auto d = rd - 1;
-            auto& dstream = streams[d];
+    // Each block of coordinates is processed in parallel, where the last
+    // coordinate of the preceding block is also fetched for comparison.
+    hsize_t block_size = std::max(buffer_size, static_cast<hsize_t>(1));
+    hsize_t num_blocks = (num_lengths + block_size - 1) / block_size;
+    size_t num_jobs = (num_threads > 1 ? std::min(static_cast<hsize_t>(num_threads) * 4, num_blocks) : 1);
+    hsize_t blocks_per_job = (num_blocks + num_jobs - 1) / num_jobs;
+
+    internal_parallel::parallelize(num_jobs, num_threads, [&](size_t job) -> void {
+        hsize_t job_start = std::min(num_lengths, job * blocks_per_job * block_size);
+        hsize_t job_end = std::min(num_lengths, job_start + blocks_per_job * block_size);
+        std::vector<std::vector<uint64_t> > buffers(ndims);
+        std::vector<const uint64_t*> columns(ndims);
+        std::vector<unsigned char> greater, equal;
+        internal_hdf5::MultiRead batch;
+
+        for (hsize_t block_start = job_start; block_start < job_end; block_start += block_size) {
+            hsize_t count = std::min(block_size, job_end - block_start);
+            bool has_previous = block_start > 0;
+            hsize_t fetch_start = block_start - has_previous;
+            hsize_t fetch_count = count + has_previous;
+
+            batch.clear();
+            for (size_t d = 0; d < ndims; ++d) {
+                columns[d] = readers[d]->fetch(fetch_start, fetch_count, buffers[d], batch);
+            }
+            if (!batch.empty()) {
+                std::lock_guard<std::mutex> lck(lock);
+                batch.run(fetch_start, fetch_count, num_lengths);
+            }
 
-            auto nextv = dstream.get();
-            if (nextv >= dimensions[d]) {
-                throw std::runtime_error("values in 'indices/" + std::to_string(d) + "' should be less than the corresponding dimension extent");
+            // Accumulating flags without branching, so that the compiler has a chance to vectorize it.
+            bool failed = false;
+            for (size_t d = 0; d < ndims; ++d) {
+                const auto* col = columns[d];
+                auto extent = dimensions[d];
+                for (hsize_t j = 0; j < fetch_count; ++j) {
+                    failed |= (col[j] >= extent);
+                }
             }
-            dstream.next();
-
-            auto& oldv = position[d];
-            if (!greater) {
-                if (nextv > oldv) {
-                    greater = true;
-                } else if (nextv < oldv) {
-                    throw std::runtime_error("coordinates in 'indices' should be strictly increasing");
+
+            // Lexicographic comparison from back to front for all coordinates at once.
+            if (!failed && fetch_count > 1) {
+                greater.assign(fetch_count, 0);
+                equal.assign(fetch_count, 1);
+                for (size_t rd = ndims; rd > 0; --rd) {
+                    const auto* col = columns[rd - 1];
+                    for (hsize_t j = 1; j < fetch_count; ++j) {
+                        greater[j] |= equal[j] & (col[j] > col[j - 1]);
+                        equal[j] &= (col[j] == col[j - 1]);
+                    }
+                }
+                for (hsize_t j = 1; j < fetch_count; ++j) {
+                    failed |= !greater[j];
                 }
             }
-            oldv = nextv;
-        }
 
-        if (!greater) {
-            throw std::runtime_error("duplicate coordinates in 'indices'");
+            if (failed) {
+                for (hsize_t j = has_previous; j < fetch_count; ++j) {
+                    check_sparse_coordinate(columns, j, j > 0, dimensions);
+                }
+            }
         }
-    }
+    });
 }
 
 template<bool satisfies_interface_>
@@ -156,12 +225,12 @@ void validate_directory(const std::filesystem::path& path, const std::string& ob
     auto ghandle = ritsuko::hdf5::open_group(handle, object_type.c_str());
 
     auto dims = validate_dimensions(ghandle);
-    auto len = validate_lengths(ghandle, catheight, options.hdf5_buffer_size);
+    auto len = validate_lengths(ghandle, catheight, options.hdf5_buffer_size, options.num_threads, options.hdf5_memory_map);
 
     // Support both dense and sparse cases.
     if (ghandle.exists("indices")) {
         auto ihandle = ritsuko::hdf5::open_group(ghandle, "indices");
-        validate_sparse_indices(ihandle, dims, len, options.hdf5_buffer_size);
+        validate_sparse_indices(ihandle, dims, len, options.hdf5_buffer_size, options.num_threads, options.hdf5_memory_map);
     } else {
         size_t prod = !dims.empty(); // prod = 0 if dims is empty, otherwise it starts at 1.
         for (auto d : dims) {
@@ -0,0 +1,178 @@
+#ifndef TAKANE_UTILS_CACHE_HPP
+#define TAKANE_UTILS_CACHE_HPP
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+#include <optional>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+namespace takane {
+
+namespace internal_cache {
+
+// Store for intermediate results that are re-used across objects in a single
+// validation session, e.g., sequence information that is shared by many
+// genomic ranges. Each entry is keyed by a string that should incorporate the
+// contents of the relevant files, so that stale entries are never used if
+// the files change. Values are type-erased so that each caller can store its
+// own type; it is the caller's responsibility to use a unique prefix in the
+// key for each type. Access is protected by a mutex so that the same cache
+// can be shared between copies of the Options in different threads.
+class SessionCache {
+public:
+    template<typename Type_>
+    std::shared_ptr<const Type_> find(const std::string& key) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        auto it = my_entries.find(key);
+        if (it == my_entries.end()) {
+            return nullptr;
+        }
+        return std::static_pointer_cast<const Type_>(it->second);
+    }
+
+    template<typename Type_>
+    void store(const std::string& key, std::shared_ptr<const Type_> value) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        my_entries[key] = std::move(value);
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lck(my_lock);
+        return my_entries.size();
+    }
+
+private:
+    std::mutex my_lock;
+    std::unordered_map<std::string, std::shared_ptr<const void> > my_entries;
+};
+
+// Limits the lifetime of the session cache to a single top-level call. If
+// caching is enabled and no cache exists, one is created for the duration of
+// the call and discarded afterwards, so that nothing persists across calls
+// unless the caller explicitly supplied its own cache. Nested calls see the
+// existing cache and leave it alone.
+class SessionScope {
+public:
+    SessionScope(std::shared_ptr<SessionCache>& cache, bool enabled) : my_cache(cache) {
+        if (enabled && !my_cache) {
+            my_cache = std::make_shared<SessionCache>();
+            my_owner = true;
+        }
+    }
+
+    ~SessionScope() {
+        if (my_owner) {
+            my_cache.reset();
+        }
+    }
+
+    SessionScope(const SessionScope&) = delete;
+    SessionScope& operator=(const SessionScope&) = delete;
+
+private:
+    std::shared_ptr<SessionCache>& my_cache;
+    bool my_owner = false;
+};
+
+// Cache to use for the current session, or nullptr if results should not be
+// cached. This is the single place where the caching policy is defined, so
+// that all callers agree with the documentation for Options::cache_results.
+// In particular, nothing is cached if a custom global validation function is
+// present, as it might have side effects that would be skipped on a hit.
+// Templated to avoid a circular dependency on the Options definition.
+template<class Options_>
+SessionCache* usable_session_cache(const Options_& options) {
+    if (!options.cache_results || options.custom_global_validate) {
+        return nullptr;
+    }
+    return options.session_cache.get();
+}
+
+// Contents of a series of files, for use in cache keys. Each file's bytes
+// are preceded by its size, so that the boundaries between files are
+// unambiguous. We use the full contents rather than a hash, as the cache
+// lookup then compares the bytes exactly; this ensures that a file cannot be
+// crafted to collide with an already-validated file and skip validation.
+// This should only be used for small files, e.g., sequence information.
+inline std::string snapshot_files(const std::vector<std::filesystem::path>& paths) {
+    std::string output;
+
+    for (const auto& path : paths) {
+        std::ifstream input(path, std::ios::binary);
+        if (!input) {
+            throw std::runtime_error("failed to open '" + path.string() + "' for caching");
+        }
+
+        std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (input.bad()) {
+            throw std::runtime_error("failed to read '" + path.string() + "' for caching");
+        }
+
+        output += std::to_string(contents.size());
+        output += ':';
+        output += contents;
+        output += ';';
+    }
+
+    return output;
+}
+
+// Cheap identity of a file for use in cache keys, based on its absolute path,
+// size and modification time, plus the device and inode where available so
+// that replacing the file (e.g., by renaming another file over it) is always
+// detected. Unlike snapshot_files(), this does not read the file, so it is
+// suitable for large files that are queried frequently; the trade-off is that
+// we miss in-place modifications that preserve both the size and modification
+// time. No value is returned if the file cannot be inspected.
+inline std::optional<std::string> identify_file(const std::filesystem::path& path) {
+    std::error_code ec;
+    auto abs = std::filesystem::absolute(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    auto size = std::filesystem::file_size(abs, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    auto mtime = std::filesystem::last_write_time(abs, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    std::string output = abs.string();
+    output += ':';
+    output += std::to_string(size);
+    output += ':';
+    output += std::to_string(mtime.time_since_epoch().count());
+
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat info;
+    if (::stat(abs.c_str(), &info) != 0) {
+        return std::nullopt;
+    }
+    output += ':';
+    output += std::to_string(static_cast<uint64_t>(info.st_dev));
+    output += ':';
+    output += std::to_string(static_cast<uint64_t>(info.st_ino));
+#endif
+
+    return output;
+}
+
+}
+
+}
+
+#endif
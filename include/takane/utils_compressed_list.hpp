@@ -15,6 +15,7 @@
 #include "utils_string.hpp"
 #include "utils_other.hpp"
 #include "utils_json.hpp"
+#include "utils_hdf5.hpp"
 
 namespace takane {
 
@@ -25,20 +26,19 @@ bool derived_from(const std::string&, const std::string&, const Options&);
 
 namespace internal_compressed_list {
 
-inline hsize_t validate_group(const H5::Group& handle, size_t concatenated_length, hsize_t buffer_size) {
+inline hsize_t validate_group(const H5::Group& handle, size_t concatenated_length, hsize_t buffer_size, int num_threads = 1, bool memory_map = true) {
     auto lhandle = ritsuko::hdf5::open_dataset(handle, "lengths");
     if (ritsuko::hdf5::exceeds_integer_limit(lhandle, 64, false)) {
         throw std::runtime_error("expected 'lengths' to have a datatype that fits in a 64-bit unsigned integer");
     }
 
     size_t len = ritsuko::hdf5::get_1d_length(lhandle.getSpace(), false);
-    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> stream(&lhandle, len, buffer_size);
-    size_t total = 0;
-    for (size_t i = 0; i < len; ++i, stream.next()) {
-        total += stream.get();
+    auto total = internal_hdf5::sum_1d_integers(lhandle, len, buffer_size, num_threads, memory_map);
+    if (!total.has_value()) {
+        throw std::runtime_error("sum of 'lengths' does not fit in a 64-bit unsigned integer");
     }
-    if (total != concatenated_length) {
-        throw std::runtime_error("sum of 'lengths' does not equal the height of the concatenated object (got " + std::to_string(total) + ", expected " + std::to_string(concatenated_length) + ")");
+    if (*total != concatenated_length) {
+        throw std::runtime_error("sum of 'lengths' does not equal the height of the concatenated object (got " + std::to_string(*total) + ", expected " + std::to_string(concatenated_length) + ")");
     }
 
     return len;
@@ -73,9 +73,9 @@ void validate_directory(const std::filesystem::path& path, const std::string& ob
 
     auto handle = ritsuko::hdf5::open_file(path / "partitions.h5");
     auto ghandle = ritsuko::hdf5::open_group(handle, object_type.c_str());
-    size_t len = validate_group(ghandle, catheight, options.hdf5_buffer_size);
+    size_t len = validate_group(ghandle, catheight, options.hdf5_buffer_size, options.num_threads, options.hdf5_memory_map);
 
-    internal_string::validate_names(ghandle, "names", len, options.hdf5_buffer_size);
+    internal_string::validate_names(ghandle, "names", len, options.hdf5_buffer_size, options.validate_utf8);
     internal_other::validate_mcols(path, "element_annotations", len, options);
     internal_other::validate_metadata(path, "other_annotations", options);
 
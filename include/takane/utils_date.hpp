@@ -0,0 +1,126 @@
+#ifndef TAKANE_UTILS_DATE_HPP
+#define TAKANE_UTILS_DATE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "ritsuko/ritsuko.hpp"
+
+namespace takane {
+
+namespace internal_date {
+
+// Fast paths for the most common layouts of dates and date-times, i.e.,
+// 'YYYY-MM-DD', 'YYYY-MM-DDTHH:MM:SSZ' and 'YYYY-MM-DDTHH:MM:SS+HH:MM'. Each
+// 8-byte window of the string is checked against a layout in a single pass
+// using SWAR, i.e., comparing all literal characters with one mask and testing
+// all digits with a couple of bitwise operations. The field values are then
+// checked with a handful of scalar comparisons.
+//
+// These fast paths are a strict subset of ritsuko's parsers; they only ever
+// report that a string is definitely valid, otherwise we fall back to
+// ritsuko's parsers to get the final answer. This means that any unusual
+// layouts (fractional seconds, leap seconds, other time zones) or invalid
+// strings are still handled exactly as before.
+class SwarLayout {
+public:
+    // 'D' indicates a digit, '?' indicates any character, and all other
+    // characters must be matched exactly.
+    SwarLayout(const char* layout) {
+        unsigned char digits[8], literal_mask[8], literal[8];
+        for (int i = 0; i < 8; ++i) {
+            char c = layout[i];
+            digits[i] = (c == 'D' ? 0xFF : 0);
+            literal_mask[i] = (c == 'D' || c == '?' ? 0 : 0xFF);
+            literal[i] = (c == 'D' || c == '?' ? 0 : static_cast<unsigned char>(c));
+        }
+        std::memcpy(&my_digits, digits, 8);
+        std::memcpy(&my_literal_mask, literal_mask, 8);
+        std::memcpy(&my_literal, literal, 8);
+    }
+
+    bool matches(const char* ptr) const {
+        uint64_t word;
+        std::memcpy(&word, ptr, 8);
+        if ((word & my_literal_mask) != my_literal) {
+            return false;
+        }
+
+        // After XOR'ing with '0', digits become 0-9, so the upper nibble must
+        // be zero and adding 6 must not overflow into the upper nibble. Any
+        // carry between bytes only occurs if the upper nibble is non-zero, in
+        // which case the check fails anyway.
+        uint64_t x = (word ^ 0x3030303030303030ull) & my_digits;
+        return ((x & 0xF0F0F0F0F0F0F0F0ull) | ((x + 0x0606060606060606ull) & 0x1010101010101010ull)) == 0;
+    }
+
+private:
+    uint64_t my_digits = 0, my_literal_mask = 0, my_literal = 0;
+};
+
+inline int two_digits(const char* ptr) {
+    return (ptr[0] - '0') * 10 + (ptr[1] - '0');
+}
+
+// Assumes that the first 10 characters have already been checked for digits and separators.
+inline bool has_valid_date_fields(const char* ptr) {
+    int year = two_digits(ptr) * 100 + two_digits(ptr + 2);
+    int month = two_digits(ptr + 5);
+    int day = two_digits(ptr + 8);
+    if (year == 0 || month < 1 || month > 12 || day < 1) {
+        return false;
+    }
+
+    static constexpr int month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int limit = month_days[month - 1];
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+        limit = 29;
+    }
+    return day <= limit;
+}
+
+inline bool is_date_fast(const char* ptr, size_t len) {
+    static const SwarLayout first("DDDD-DD-"), second("DD-DD-DD");
+    return len == 10 && first.matches(ptr) && second.matches(ptr + 2) && has_valid_date_fields(ptr);
+}
+
+inline bool is_rfc3339_fast(const char* ptr, size_t len) {
+    static const SwarLayout date("DDDD-DD-"), time("DDTDD:DD"), zulu("D:DD:DDZ"), offset1(":DD?DD:D"), offset2("DD?DD:DD");
+
+    if (len == 20) {
+        if (!date.matches(ptr) || !time.matches(ptr + 8) || !zulu.matches(ptr + 12)) {
+            return false;
+        }
+    } else if (len == 25) {
+        if (!date.matches(ptr) || !time.matches(ptr + 8) || !offset1.matches(ptr + 16) || !offset2.matches(ptr + 17)) {
+            return false;
+        }
+        char sign = ptr[19];
+        int offset_hour = two_digits(ptr + 20), offset_minute = two_digits(ptr + 23);
+        if ((sign != '+' && sign != '-') || offset_hour > 23 || offset_minute > 59) {
+            return false;
+        }
+        if (sign == '-' && offset_hour == 0 && offset_minute == 0) { // "unknown local offset" in RFC 3339, let ritsuko handle it.
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    return has_valid_date_fields(ptr) && two_digits(ptr + 11) <= 23 && two_digits(ptr + 14) <= 59 && two_digits(ptr + 17) <= 59;
+}
+
+inline bool is_date(const char* ptr, size_t len) {
+    return is_date_fast(ptr, len) || ritsuko::is_date(ptr, len);
+}
+
+inline bool is_rfc3339(const char* ptr, size_t len) {
+    return is_rfc3339_fast(ptr, len) || ritsuko::is_rfc3339(ptr, len);
+}
+
+}
+
+}
+
+#endif
@@ -1,16 +1,22 @@
 #ifndef TAKANE_UTILS_FACTOR_HPP
 #define TAKANE_UTILS_FACTOR_HPP
 
-#include <unordered_set>
 #include <string>
 #include <cstdint>
 #include <vector>
 #include <stdexcept>
 #include <optional>
+#include <limits>
+#include <string_view>
+#include <algorithm>
 
 #include "ritsuko/ritsuko.hpp"
 #include "ritsuko/hdf5/hdf5.hpp"
 
+#include "utils_hdf5.hpp"
+#include "utils_hash.hpp"
+#include "utils_simd.hpp"
+
 namespace takane {
 
 namespace internal_factor {
@@ -39,29 +45,27 @@ struct DefaultFactorMessenger {
 // These factor level/code checks are useful elsewhere but with different error messages;
 // in such cases, we just do some compile-time switches that only affect the error message.
 template<class ErrorMessenger_ = DefaultFactorMessenger>
-hsize_t validate_factor_levels(const H5::Group& handle, const std::string& name, hsize_t buffer_size) {
+hsize_t validate_factor_levels(const H5::Group& handle, const std::string& name, hsize_t buffer_size, bool check_utf8 = false) {
     auto lhandle = ritsuko::hdf5::open_dataset(handle, name.c_str());
     if (!ritsuko::hdf5::is_utf8_string(lhandle)) {
         throw std::runtime_error("expected '" + name + "' to have a datatype that can be represented by a UTF-8 encoded string");
     }
 
     auto len = ritsuko::hdf5::get_1d_length(lhandle.getSpace(), false);
-    std::unordered_set<std::string> present;
+    internal_hash::StringSet present;
+    present.reserve(std::min<hsize_t>(len, internal_hash::StringSet::max_reserve()));
 
-    ritsuko::hdf5::Stream1dStringDataset stream(&lhandle, len, buffer_size);
-    for (hsize_t i = 0; i < len; ++i, stream.next()) {
-        auto x = stream.steal();
-        if (present.find(x) != present.end()) {
-            throw std::runtime_error("'" + name + "' contains duplicated " + ErrorMessenger_::level() + " '" + x + "'");
+    internal_hdf5::iterate_1d_strings(lhandle, len, buffer_size, [&](hsize_t, std::string_view x) -> void {
+        if (!present.insert(x)) {
+            throw std::runtime_error("'" + name + "' contains duplicated " + ErrorMessenger_::level() + " '" + std::string(x) + "'");
         }
-        present.insert(std::move(x));
-    }
+    }, check_utf8);
 
     return len;
 }
 
 template<class ErrorMessenger_ = DefaultFactorMessenger>
-hsize_t validate_factor_codes(const H5::Group& handle, const std::string& name, hsize_t num_levels, hsize_t buffer_size, bool allow_missing = true) {
+hsize_t validate_factor_codes(const H5::Group& handle, const std::string& name, hsize_t num_levels, hsize_t buffer_size, bool allow_missing = true, bool memory_map = true) {
     auto chandle = ritsuko::hdf5::open_dataset(handle, name.c_str());
     if (ritsuko::hdf5::exceeds_integer_limit(chandle, 64, false)) {
         throw std::runtime_error("expected a datatype for '" + name + "' that fits in a 64-bit unsigned integer");
@@ -73,16 +77,35 @@ hsize_t validate_factor_codes(const H5::Group& handle, const std::string& name,
     }
 
     auto len = ritsuko::hdf5::get_1d_length(chandle.getSpace(), false);
-    ritsuko::hdf5::Stream1dNumericDataset<uint64_t> stream(&chandle, len, buffer_size);
-    for (hsize_t i = 0; i < len; ++i, stream.next()) {
-        auto x = stream.get();
-        if (missing_placeholder.has_value() && x == *missing_placeholder) {
-            continue;
-        }
-        if (static_cast<hsize_t>(x) >= num_levels) {
-            throw std::runtime_error("expected " + ErrorMessenger_::codes() + " to be less than the number of " + ErrorMessenger_::levels() + " in '" + name + "'");
+    internal_hdf5::dispatch_integer_type<uint64_t>(chandle, [&](auto tag) -> void {
+        typedef decltype(tag) Code_;
+
+        // A placeholder that doesn't fit into the native type can never match any code.
+        std::optional<Code_> native_placeholder;
+        if (missing_placeholder.has_value() && *missing_placeholder <= std::numeric_limits<Code_>::max()) {
+            native_placeholder = static_cast<Code_>(*missing_placeholder);
         }
-    }
+
+        // Masking the placeholder to zero is harmless when there is no placeholder, as it doesn't change the maximum.
+        Code_ masked = native_placeholder.value_or(0);
+        auto instructions = internal_simd::available_instructions();
+
+        internal_hdf5::iterate_1d_blocks<Code_>(chandle, len, buffer_size, memory_map, [&](hsize_t, hsize_t count, const Code_* codes) {
+            if (static_cast<hsize_t>(internal_simd::masked_max(codes, count, masked, instructions)) < num_levels) {
+                return;
+            }
+
+            for (hsize_t i = 0; i < count; ++i) {
+                auto x = codes[i];
+                if (native_placeholder.has_value() && x == *native_placeholder) {
+                    continue;
+                }
+                if (static_cast<hsize_t>(x) >= num_levels) {
+                    throw std::runtime_error("expected " + ErrorMessenger_::codes() + " to be less than the number of " + ErrorMessenger_::levels() + " in '" + name + "'");
+                }
+            }
+        });
+    });
 
     return len;
 }
@@ -12,27 +12,79 @@
 #include "utils_json.hpp"
 #include "byteme/byteme.hpp"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#define TAKANE_HAS_PREAD 1
+#endif
+
 namespace takane {
 
 namespace internal_files {
 
+// Read up to 'len' bytes from the start of the file into 'store', returning
+// the number of bytes that were actually read. Signatures are only a handful
+// of bytes, so where possible, we use a single pread() on a raw descriptor
+// instead of constructing a byteme reader with its own (large) buffer.
+inline std::size_t read_prefix(const std::filesystem::path& path, unsigned char* store, std::size_t len) {
+#ifdef TAKANE_HAS_PREAD
+    // O_CLOEXEC ensures that the descriptor is not leaked into child processes spawned by other threads.
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("failed to open file at '" + path.string() + "'");
+    }
+
+    // Short reads are possible in principle, so we keep going until EOF.
+    std::size_t total = 0;
+    while (total < len) {
+        auto nread = ::pread(fd, store + total, len - total, total);
+        if (nread < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::close(fd);
+            throw std::runtime_error("failed to read file at '" + path.string() + "'");
+        }
+        if (nread == 0) {
+            break;
+        }
+        total += nread;
+    }
+
+    ::close(fd);
+    return total;
+#else
+    auto reader = internal_other::open_reader<byteme::RawFileReader>(path, byteme::RawFileReaderOptions());
+    return reader->read(store, len);
+#endif
+}
+
+template<typename Type_>
+void compare_signature(const std::vector<Type_>& observed, const Type_* expected, std::size_t len, const char* msg, const std::filesystem::path& path) {
+    for (std::size_t i = 0; i < len; ++i) {
+        if (observed[i] != expected[i]) {
+            throw std::runtime_error("incorrect " + std::string(msg) + " file signature for '" + path.string() + "'");
+        }
+    }
+}
+
 template<class Reader_, typename Type_>
 void check_signature(Reader_& reader, const Type_* expected, std::size_t len, const char* msg, const std::filesystem::path& path) {
     std::vector<Type_> buffer(len);
     if (reader.read(reinterpret_cast<unsigned char*>(buffer.data()), len) != len) {
         throw std::runtime_error("incomplete " + std::string(msg) + " file signature for '" + path.string() + "'");
     }
-    for (std::size_t i = 0; i < len; ++i) {
-        if (buffer[i] != expected[i]) {
-            throw std::runtime_error("incorrect " + std::string(msg) + " file signature for '" + path.string() + "'");
-        }
-    }
+    compare_signature(buffer, expected, len, msg, path);
 }
 
 template<typename Type_>
 void check_raw_signature(const std::filesystem::path& path, const Type_* expected, std::size_t len, const char* msg) {
-    auto reader = internal_other::open_reader<byteme::RawFileReader>(path, byteme::RawFileReaderOptions());
-    check_signature(*reader, expected, len, msg, path);
+    std::vector<Type_> buffer(len);
+    if (read_prefix(path, reinterpret_cast<unsigned char*>(buffer.data()), len) != len) {
+        throw std::runtime_error("incomplete " + std::string(msg) + " file signature for '" + path.string() + "'");
+    }
+    compare_signature(buffer, expected, len, msg, path);
 }
 
 template<typename Type_>
@@ -47,8 +99,7 @@ inline void check_gzip_signature(const std::filesystem::path& path) {
 }
 
 inline void extract_signature(const std::filesystem::path& path, unsigned char* store, std::size_t len) {
-    auto reader = internal_other::open_reader<byteme::RawFileReader>(path, byteme::RawFileReaderOptions());
-    if (reader->read(store, len) != len) {
+    if (read_prefix(path, store, len) != len) {
         throw std::runtime_error("file at '" + path.string() + "' is too small to extract a signature of length " + std::to_string(len));
     }
 }
@@ -88,4 +139,7 @@ inline void check_sequence_type(const internal_json::JsonObjectMap& objmap, cons
 
 }
 
+// Internal to this header, so that it doesn't leak into user code.
+#undef TAKANE_HAS_PREAD
+
 #endif
@@ -0,0 +1,243 @@
+#ifndef TAKANE_UTILS_HASH_HPP
+#define TAKANE_UTILS_HASH_HPP
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+namespace takane {
+
+namespace internal_hash {
+
+// Fast non-cryptographic hash for strings, processing 8 bytes at a time and
+// finishing with the splitmix64 mixer to spread the bits.
+inline uint64_t hash_string(const char* ptr, size_t len) {
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ static_cast<uint64_t>(len);
+    while (len >= 8) {
+        uint64_t k;
+        std::memcpy(&k, ptr, 8);
+        h = (h ^ k) * 0xff51afd7ed558ccdull;
+        h ^= h >> 32;
+        ptr += 8;
+        len -= 8;
+    }
+
+    if (len) {
+        uint64_t k = 0;
+        std::memcpy(&k, ptr, len);
+        h = (h ^ k) * 0xc4ceb9fe1a85ec53ull;
+    }
+
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+// Open-addressing hash set of strings, intended for checking uniqueness.
+// The contents of all strings are stored contiguously in an arena, where
+// each string is prefixed by its length as a variable-length integer. Each
+// slot of the table is a single 64-bit word, containing the offset into the
+// arena (plus 1, so that zero indicates an empty slot) in the lower 40 bits
+// and the top 24 bits of the hash in the upper bits. This allows us to skip
+// most string comparisons for non-matching entries during linear probing.
+class StringSet {
+public:
+    // Returns true if 'x' was inserted, or false if it was already present.
+    bool insert(std::string_view x) {
+        if ((my_size + 1) * 4 > my_slots.size() * 3) {
+            rehash(std::max(my_slots.size() * 2, static_cast<size_t>(16)));
+        }
+
+        uint64_t h = hash_string(x.data(), x.size());
+        size_t pos = find(x, h);
+        if (my_slots[pos]) {
+            return false;
+        }
+
+        uint64_t offset = my_arena.size() + 1;
+        if (offset > offset_mask) {
+            throw std::runtime_error("too many strings to store in a hash set");
+        }
+        append(x);
+        my_slots[pos] = offset | (h & tag_mask);
+        ++my_size;
+        return true;
+    }
+
+    bool contains(std::string_view x) const {
+        if (my_size == 0) {
+            return false;
+        }
+        uint64_t h = hash_string(x.data(), x.size());
+        return my_slots[find(x, h)] != 0;
+    }
+
+    size_t size() const {
+        return my_size;
+    }
+
+    bool empty() const {
+        return my_size == 0;
+    }
+
+    // Preallocate space for 'n' strings with a total length of 'total_length'.
+    // Callers should cap 'n' with max_reserve() if it is taken from a length
+    // declared in a file, as the file might not actually contain that many
+    // strings, e.g., a chunked dataset that is mostly fill values. Any
+    // further growth is handled by insert() as the strings are encountered.
+    void reserve(size_t n, size_t total_length = 0) {
+        // Written to avoid overflow for very large 'n', as the table is never
+        // allowed to exceed a quarter of the addressable space.
+        constexpr size_t max_target = static_cast<size_t>(1) << (std::numeric_limits<size_t>::digits - 2);
+        size_t target = 16;
+        while (target / 4 * 3 < n && target < max_target) {
+            target *= 2;
+        }
+        if (target > my_slots.size()) {
+            rehash(target);
+        }
+        if (total_length <= std::numeric_limits<size_t>::max() - n) {
+            my_arena.reserve(total_length + n);
+        }
+    }
+
+    // Limit on the number of strings to preallocate for a declared length.
+    static constexpr size_t max_reserve() {
+        return static_cast<size_t>(1) << 20;
+    }
+
+private:
+    static constexpr uint64_t offset_mask = (static_cast<uint64_t>(1) << 40) - 1;
+    static constexpr uint64_t tag_mask = ~offset_mask;
+
+    std::vector<uint64_t> my_slots;
+    std::vector<char> my_arena;
+    size_t my_size = 0;
+
+    void append(std::string_view x) {
+        size_t len = x.size();
+        do {
+            unsigned char byte = len & 0x7f;
+            len >>= 7;
+            if (len) {
+                byte |= 0x80;
+            }
+            my_arena.push_back(static_cast<char>(byte));
+        } while (len);
+        my_arena.insert(my_arena.end(), x.begin(), x.end());
+    }
+
+    std::string_view extract(uint64_t slot) const {
+        const char* ptr = my_arena.data() + (slot & offset_mask) - 1;
+        size_t len = 0;
+        int shift = 0;
+        unsigned char byte;
+        do {
+            byte = static_cast<unsigned char>(*ptr);
+            len |= static_cast<size_t>(byte & 0x7f) << shift;
+            shift += 7;
+            ++ptr;
+        } while (byte & 0x80);
+        return std::string_view(ptr, len);
+    }
+
+    // Returns the position of the slot containing 'x', or the empty slot where 'x' should be inserted.
+    size_t find(std::string_view x, uint64_t h) const {
+        size_t mask = my_slots.size() - 1;
+        size_t pos = h & mask;
+        uint64_t tag = h & tag_mask;
+        while (true) {
+            uint64_t current = my_slots[pos];
+            if (current == 0) {
+                return pos;
+            }
+            if ((current & tag_mask) == tag && extract(current) == x) {
+                return pos;
+            }
+            pos = (pos + 1) & mask;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<uint64_t> old(capacity);
+        old.swap(my_slots);
+        size_t mask = capacity - 1;
+        for (auto current : old) {
+            if (current) {
+                auto x = extract(current);
+                size_t pos = hash_string(x.data(), x.size()) & mask;
+                while (my_slots[pos]) {
+                    pos = (pos + 1) & mask;
+                }
+                my_slots[pos] = current;
+            }
+        }
+    }
+};
+
+// Small direct-mapped cache of short strings that have recently passed some
+// check, e.g., parsing of dates or lookup of factor levels. This is intended
+// for highly repetitive columns, where a repeated value can be accepted with
+// a hash and a comparison instead of repeating the check. Each slot holds a
+// single string, so collisions just replace the previous entry; strings that
+// are longer than 'max_length' are never cached. Only values that passed the
+// check are stored, so a failing value is always re-checked to report the
+// error.
+class RecentStrings {
+public:
+    RecentStrings(size_t num_slots = 4096) {
+        size_t capacity = 1;
+        while (capacity < num_slots) {
+            capacity *= 2;
+        }
+        my_slots.resize(capacity);
+    }
+
+    // Returns the result of 'fun(x)', which is skipped if 'x' previously returned true.
+    template<class Function_>
+    bool check(std::string_view x, Function_ fun) {
+        size_t len = x.size();
+        if (len > max_length) {
+            return fun(x);
+        }
+
+        uint64_t h = hash_string(x.data(), len);
+        auto& slot = my_slots[h & (my_slots.size() - 1)];
+        if (slot.length == len && slot.hash == h && std::memcmp(slot.data, x.data(), len) == 0) {
+            return true;
+        }
+
+        if (!fun(x)) {
+            return false;
+        }
+        slot.hash = h;
+        slot.length = len;
+        std::memcpy(slot.data, x.data(), len);
+        return true;
+    }
+
+private:
+    static constexpr size_t max_length = 39;
+
+    struct Slot {
+        uint64_t hash = 0;
+        unsigned char length = max_length + 1; // i.e., empty.
+        char data[max_length];
+    };
+
+    std::vector<Slot> my_slots;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,994 @@
+#ifndef TAKANE_UTILS_HDF5_HPP
+#define TAKANE_UTILS_HDF5_HPP
+
+#include "H5Cpp.h"
+#include "ritsuko/hdf5/hdf5.hpp"
+#include "ritsuko/hdf5/vls/vls.hpp"
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <mutex>
+#include <optional>
+#include <memory>
+#include <stdexcept>
+
+#include "utils_simd.hpp"
+#include "utils_utf8.hpp"
+#include "utils_parallel.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define TAKANE_HAS_MMAP 1
+#endif
+
+namespace takane {
+
+namespace internal_hdf5 {
+
+// Read-only memory mapping of the raw bytes of a contiguous HDF5 dataset.
+// This is only non-empty if the dataset's storage can be used directly as an
+// array of the in-memory type, see map_1d_dataset().
+class MappedDataset {
+public:
+    MappedDataset() = default;
+
+    MappedDataset(const MappedDataset&) = delete;
+    MappedDataset& operator=(const MappedDataset&) = delete;
+
+    MappedDataset(MappedDataset&& other) noexcept {
+        swap(other);
+    }
+
+    MappedDataset& operator=(MappedDataset&& other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~MappedDataset() {
+        release();
+    }
+
+public:
+    bool mapped() const {
+        return contents != NULL;
+    }
+
+    const unsigned char* data() const {
+        return contents;
+    }
+
+public:
+    void reset(void* b, size_t bl, const unsigned char* c) {
+        release();
+        base = b;
+        base_length = bl;
+        contents = c;
+    }
+
+private:
+    void* base = NULL;
+    size_t base_length = 0;
+    const unsigned char* contents = NULL;
+
+    void swap(MappedDataset& other) {
+        std::swap(base, other.base);
+        std::swap(base_length, other.base_length);
+        std::swap(contents, other.contents);
+    }
+
+    void release() {
+#ifdef TAKANE_HAS_MMAP
+        if (base) {
+            munmap(base, base_length);
+        }
+#endif
+        base = NULL;
+        base_length = 0;
+        contents = NULL;
+    }
+};
+
+// Try to memory-map a 1-dimensional dataset of length 'len' as an array of
+// 'Type_'. This only succeeds for datasets that are stored contiguously (no
+// chunking, filters or external storage) in a file opened read-only with the
+// default driver, where the on-disk datatype is identical to the native
+// representation of 'Type_' so that no conversion is required. Otherwise, an
+// empty MappedDataset is returned and the caller should read it via HDF5.
+template<typename Type_>
+MappedDataset map_1d_dataset(const H5::DataSet& handle, hsize_t len) {
+    MappedDataset output;
+
+#ifdef TAKANE_HAS_MMAP
+    if (len == 0) {
+        return output;
+    }
+
+    auto cplist = handle.getCreatePlist();
+    if (cplist.getLayout() != H5D_CONTIGUOUS || cplist.getNfilters() != 0 || cplist.getExternalCount() != 0) {
+        return output;
+    }
+
+    {
+        auto dtype = handle.getDataType();
+        if (!(dtype == ritsuko::hdf5::as_numeric_datatype<Type_>())) {
+            return output;
+        }
+    }
+
+    hid_t did = handle.getId();
+    haddr_t offset = H5Dget_offset(did);
+    if (offset == HADDR_UNDEF || offset % alignof(Type_) != 0) {
+        return output;
+    }
+
+    size_t nbytes = static_cast<size_t>(len) * sizeof(Type_);
+    if (handle.getStorageSize() < nbytes) {
+        return output;
+    }
+
+    // Only mapping files that are opened read-only with the default driver,
+    // otherwise the file's contents might be somewhere else (or dirty in HDF5's cache).
+    std::string fname;
+    {
+        hid_t fid = H5Iget_file_id(did);
+        if (fid < 0) {
+            return output;
+        }
+
+        unsigned intent = 0;
+        bool okay = (H5Fget_intent(fid, &intent) >= 0 && intent == H5F_ACC_RDONLY);
+        if (okay) {
+            hid_t fapl = H5Fget_access_plist(fid);
+            okay = (fapl >= 0 && H5Pget_driver(fapl) == H5FD_SEC2);
+            if (fapl >= 0) {
+                H5Pclose(fapl);
+            }
+        }
+
+        if (okay) {
+            ssize_t nlen = H5Fget_name(fid, NULL, 0);
+            if (nlen > 0) {
+                fname.resize(nlen + 1);
+                H5Fget_name(fid, fname.data(), fname.size());
+                fname.resize(nlen);
+            }
+        }
+
+        H5Fclose(fid);
+        if (!okay || fname.empty()) {
+            return output;
+        }
+    }
+
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return output;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < offset + nbytes) {
+        close(fd);
+        return output;
+    }
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t aligned_offset = (offset / page) * page;
+    size_t delta = offset - aligned_offset;
+    size_t map_length = delta + nbytes;
+
+    void* ptr = mmap(NULL, map_length, PROT_READ, MAP_PRIVATE, fd, aligned_offset);
+    close(fd); // mapping remains valid after closing the descriptor.
+    if (ptr == MAP_FAILED) {
+        return output;
+    }
+
+    madvise(ptr, map_length, MADV_SEQUENTIAL);
+    output.reset(ptr, map_length, static_cast<const unsigned char*>(ptr) + delta);
+#else
+    (void)handle;
+    (void)len;
+#endif
+
+    return output;
+}
+
+// Iterate over a 1-dimensional dataset of length 'len' in contiguous blocks.
+// 'fun' is called with the start of each block, its length and a pointer to
+// its contents. If 'memory_map = true' and the dataset can be mapped, the
+// pointer refers directly to the mapped file; otherwise, each block is read
+// into a buffer with the usual hyperslab selections.
+template<typename Type_, class Function_>
+void iterate_1d_blocks(const H5::DataSet& handle, hsize_t len, hsize_t buffer_size, bool memory_map, Function_ fun) {
+    if (len == 0) {
+        return;
+    }
+
+    if (memory_map) {
+        auto mapped = map_1d_dataset<Type_>(handle, len);
+        if (mapped.mapped()) {
+            auto ptr = reinterpret_cast<const Type_*>(mapped.data());
+            hsize_t block_size = std::max(buffer_size, static_cast<hsize_t>(1));
+            for (hsize_t start = 0; start < len; start += block_size) {
+                hsize_t count = std::min(block_size, len - start);
+                fun(start, count, ptr + start);
+            }
+            return;
+        }
+    }
+
+    hsize_t block_size = ritsuko::hdf5::pick_1d_block_size(handle.getCreatePlist(), len, buffer_size);
+    std::vector<Type_> buffer(block_size);
+    H5::DataSpace mspace(1, &block_size), dspace(1, &len);
+    const auto& mtype = ritsuko::hdf5::as_numeric_datatype<Type_>();
+    constexpr hsize_t zero = 0;
+
+    for (hsize_t start = 0; start < len; start += block_size) {
+        hsize_t count = std::min(block_size, len - start);
+        mspace.selectHyperslab(H5S_SELECT_SET, &count, &zero);
+        dspace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+        handle.read(buffer.data(), mtype, mspace, dspace);
+        fun(start, count, static_cast<const Type_*>(buffer.data()));
+    }
+}
+
+// Bump allocator for the variable-length strings read by HDF5, which is
+// installed as the memory manager for the dataset transfer. This means that
+// the strings in each block are reclaimed all at once by reset(), rather than
+// having a malloc() and free() for every string. Chunks are recycled between
+// arenas on the same thread, so that repeated reads across many datasets do
+// not need to allocate new memory.
+class VlenArena {
+public:
+    VlenArena() {
+        my_chunks.swap(pool());
+    }
+
+    ~VlenArena() {
+        auto& recycled = pool();
+        if (recycled.empty()) {
+            // Not holding onto too much memory, e.g., after reading a block of very large strings.
+            size_t total = 0, keep = 0;
+            for (; keep < my_chunks.size(); ++keep) {
+                total += my_chunks[keep].size;
+                if (total > max_retained) {
+                    break;
+                }
+            }
+            my_chunks.resize(keep);
+            recycled.swap(my_chunks);
+        }
+    }
+
+    VlenArena(const VlenArena&) = delete;
+    VlenArena& operator=(const VlenArena&) = delete;
+
+public:
+    void* allocate(size_t n) {
+        n = (n + alignment - 1) / alignment * alignment;
+        while (my_index < my_chunks.size()) {
+            auto& current = my_chunks[my_index];
+            if (my_offset + n <= current.size) {
+                void* ptr = current.data.get() + my_offset;
+                my_offset += n;
+                return ptr;
+            }
+            ++my_index;
+            my_offset = 0;
+        }
+
+        size_t size = std::max(n, default_chunk_size);
+        my_chunks.push_back(Chunk{ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+        my_offset = n;
+        return my_chunks.back().data.get();
+    }
+
+    void reset() {
+        my_index = 0;
+        my_offset = 0;
+    }
+
+    static void* allocate_callback(size_t n, void* info) {
+        try {
+            return static_cast<VlenArena*>(info)->allocate(n);
+        } catch (...) {
+            return NULL;
+        }
+    }
+
+    static void free_callback(void*, void*) {}
+
+private:
+    static constexpr size_t alignment = 16;
+    static constexpr size_t default_chunk_size = 1048576;
+    static constexpr size_t max_retained = 67108864;
+
+    struct Chunk {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Chunk> my_chunks;
+    size_t my_index = 0, my_offset = 0;
+
+    static std::vector<Chunk>& pool() {
+        thread_local std::vector<Chunk> chunks;
+        return chunks;
+    }
+};
+
+// Number of slabs along the first dimension to read in each block, given the
+// extents of an N-dimensional dataset. For 1-dimensional datasets, this
+// respects the chunking of the dataset, as in ritsuko's streams.
+inline hsize_t pick_slabs_per_block(const H5::DataSet& handle, const std::vector<hsize_t>& extents, hsize_t buffer_size) {
+    if (extents.size() == 1) {
+        return ritsuko::hdf5::pick_1d_block_size(handle.getCreatePlist(), extents[0], buffer_size);
+    }
+    hsize_t per_slab = 1;
+    for (size_t d = 1; d < extents.size(); ++d) {
+        per_slab *= extents[d];
+    }
+    hsize_t slabs = std::max(static_cast<hsize_t>(1), buffer_size / std::max(per_slab, static_cast<hsize_t>(1)));
+
+    // Rounding to a multiple of the chunk extent along the first dimension,
+    // so that each chunk only needs to be decompressed for a single block.
+    auto cplist = handle.getCreatePlist();
+    if (cplist.getLayout() == H5D_CHUNKED) {
+        std::vector<hsize_t> chunk_extents(extents.size());
+        cplist.getChunk(chunk_extents.size(), chunk_extents.data());
+        hsize_t chunk_slabs = std::max(chunk_extents[0], static_cast<hsize_t>(1));
+        slabs = std::max(chunk_slabs, slabs / chunk_slabs * chunk_slabs);
+    }
+
+    return slabs;
+}
+
+// Calls 'fun(start, count, mspace, dspace)' for contiguous blocks of elements
+// in an N-dimensional dataset in row-major order, where each block consists
+// of whole slabs along the first dimension. 'start' and 'count' refer to the
+// flattened elements, and 'mspace' and 'dspace' are already selected for the
+// block, where 'mspace' is 1-dimensional and starts at the first element.
+template<class Function_>
+void iterate_nd_blocks(const std::vector<hsize_t>& extents, hsize_t slabs_per_block, Function_ fun) {
+    hsize_t per_slab = 1;
+    for (size_t d = 1; d < extents.size(); ++d) {
+        per_slab *= extents[d];
+    }
+    hsize_t num_slabs = extents[0];
+    if (num_slabs == 0 || per_slab == 0) {
+        return;
+    }
+
+    hsize_t mlen = slabs_per_block * per_slab;
+    H5::DataSpace mspace(1, &mlen), dspace(extents.size(), extents.data());
+    std::vector<hsize_t> offset(extents.size()), counts(extents);
+    constexpr hsize_t zero = 0;
+
+    for (hsize_t slab = 0; slab < num_slabs; slab += slabs_per_block) {
+        hsize_t num = std::min(slabs_per_block, num_slabs - slab);
+        offset[0] = slab;
+        counts[0] = num;
+        dspace.selectHyperslab(H5S_SELECT_SET, counts.data(), offset.data());
+        hsize_t count = num * per_slab;
+        mspace.selectHyperslab(H5S_SELECT_SET, &count, &zero);
+        fun(slab * per_slab, count, mspace, dspace);
+    }
+}
+
+// Calls 'fun(i, x)' for each string 'x' in an N-dimensional string dataset,
+// where 'x' is a std::string_view that is only valid during the call and 'i'
+// is the index of the string in row-major order.
+//
+// For fixed-length strings, each block is read as raw bytes in the file
+// datatype and each element is sliced in place up to the first NUL terminator
+// (or the full width, if unterminated), consistent with ritsuko's streams.
+//
+// For variable-length strings, each block is read into an array of pointers
+// with the strings themselves allocated from a VlenArena, which is reset
+// after the block has been processed. An error is raised for NULL pointers.
+//
+// In both cases, this avoids any allocations per element. If 'check_utf8' is
+// true, an error is also raised for any string that is not valid UTF-8.
+template<class Function_>
+void iterate_nd_strings(const H5::DataSet& handle, const std::vector<hsize_t>& extents, hsize_t buffer_size, Function_ fun, bool check_utf8 = false) {
+    auto dtype = handle.getStrType();
+    hsize_t slabs_per_block = pick_slabs_per_block(handle, extents, buffer_size);
+    auto instructions = internal_simd::available_instructions();
+
+    auto process = [&](hsize_t i, std::string_view x) -> void {
+        if (check_utf8 && !internal_utf8::is_valid(x, instructions)) {
+            throw std::runtime_error("detected an invalid UTF-8 sequence for string " + std::to_string(i) + " in '" + ritsuko::hdf5::get_name(handle) + "'");
+        }
+        fun(i, x);
+    };
+
+    if (dtype.isVariableStr()) {
+        VlenArena arena;
+        H5::DSetMemXferPropList xfer;
+        if (H5Pset_vlen_mem_manager(xfer.getId(), &VlenArena::allocate_callback, &arena, &VlenArena::free_callback, NULL) < 0) {
+            throw std::runtime_error("failed to set the memory manager for variable length strings");
+        }
+
+        std::vector<char*> pointers;
+        iterate_nd_blocks(extents, slabs_per_block, [&](hsize_t start, hsize_t count, const H5::DataSpace& mspace, const H5::DataSpace& dspace) -> void {
+            pointers.resize(std::max(pointers.size(), static_cast<size_t>(count)));
+            arena.reset();
+            handle.read(pointers.data(), dtype, mspace, dspace, xfer);
+
+            for (hsize_t i = 0; i < count; ++i) {
+                if (pointers[i] == NULL) {
+                    throw std::runtime_error("detected a NULL pointer for a variable length string in '" + ritsuko::hdf5::get_name(handle) + "'");
+                }
+                process(start + i, std::string_view(pointers[i]));
+            }
+        });
+        return;
+    }
+
+    size_t width = dtype.getSize();
+    std::vector<char> buffer;
+    iterate_nd_blocks(extents, slabs_per_block, [&](hsize_t start, hsize_t count, const H5::DataSpace& mspace, const H5::DataSpace& dspace) -> void {
+        buffer.resize(std::max(buffer.size(), static_cast<size_t>(count * width)));
+        handle.read(buffer.data(), dtype, mspace, dspace);
+
+        const char* ptr = buffer.data();
+        for (hsize_t i = 0; i < count; ++i, ptr += width) {
+            auto terminator = static_cast<const char*>(std::memchr(ptr, '\0', width));
+            process(start + i, std::string_view(ptr, terminator ? static_cast<size_t>(terminator - ptr) : width));
+        }
+    });
+}
+
+// Same as above, for a 1-dimensional string dataset of length 'len'.
+template<class Function_>
+void iterate_1d_strings(const H5::DataSet& handle, hsize_t len, hsize_t buffer_size, Function_ fun, bool check_utf8 = false) {
+    iterate_nd_strings(handle, std::vector<hsize_t>{ len }, buffer_size, std::move(fun), check_utf8);
+}
+
+// Checks that a string dataset can be read, i.e., there are no NULL pointers
+// for variable-length strings. Fixed-length strings are always valid so
+// there's no need to read them, unless we also want to check for UTF-8.
+inline void validate_nd_strings(const H5::DataSet& handle, const std::vector<hsize_t>& extents, hsize_t buffer_size, bool check_utf8 = false) {
+    if (!check_utf8 && !handle.getStrType().isVariableStr()) {
+        return;
+    }
+    iterate_nd_strings(handle, extents, buffer_size, [](hsize_t, std::string_view) -> void {}, check_utf8);
+}
+
+inline void validate_1d_strings(const H5::DataSet& handle, hsize_t len, hsize_t buffer_size, bool check_utf8 = false) {
+    validate_nd_strings(handle, std::vector<hsize_t>{ len }, buffer_size, check_utf8);
+}
+
+// Checks that all pointers in a VLS 'pointers' dataset (of any
+// dimensionality) lie within the 'heap' of length 'heap_length'; this
+// replaces ritsuko's serial validate_1d_array() and validate_nd_array().
+// Blocks of whole slabs are distributed across 'num_threads' threads, where
+// each thread reads its blocks while holding a shared lock (as the HDF5
+// library might not be thread-safe) and then checks the bounds without
+// branching, so that the compiler can vectorize the comparisons.
+//
+// If 'check_utf8' is true, the strings referenced by each block are also
+// checked for valid UTF-8 in the same pass. Each string is truncated at its
+// first NUL, as in ritsuko. To avoid a read per string, the pointers in each
+// block are sorted by offset and nearby strings are checked from a single
+// read of the heap. The earliest invalid string is always reported.
+inline void validate_vls_pointers(
+    const H5::DataSet& pointers,
+    const std::vector<hsize_t>& extents,
+    const H5::DataSet& heap,
+    hsize_t heap_length,
+    hsize_t buffer_size,
+    int num_threads,
+    bool check_utf8)
+{
+    hsize_t per_slab = 1;
+    for (size_t d = 1; d < extents.size(); ++d) {
+        per_slab *= extents[d];
+    }
+    hsize_t num_slabs = extents[0];
+    if (num_slabs == 0 || per_slab == 0) {
+        return;
+    }
+
+    typedef ritsuko::hdf5::vls::Pointer<uint64_t, uint64_t> Pointer;
+    auto ptype = ritsuko::hdf5::vls::define_pointer_datatype<uint64_t, uint64_t>();
+    hsize_t slabs_per_block = pick_slabs_per_block(pointers, extents, buffer_size);
+    std::string name = ritsuko::hdf5::get_name(pointers);
+    auto instructions = internal_simd::available_instructions();
+    hsize_t window = std::max(buffer_size, static_cast<hsize_t>(65536));
+
+    hsize_t num_blocks = (num_slabs + slabs_per_block - 1) / slabs_per_block;
+    size_t num_jobs = (num_threads > 1 ? std::min(static_cast<hsize_t>(num_threads) * 4, num_blocks) : 1);
+    hsize_t blocks_per_job = (num_blocks + num_jobs - 1) / num_jobs;
+    std::mutex lock;
+
+    internal_parallel::parallelize(num_jobs, num_threads, [&](size_t job) -> void {
+        hsize_t job_start = std::min(num_slabs, job * blocks_per_job * slabs_per_block);
+        hsize_t job_end = std::min(num_slabs, job_start + blocks_per_job * slabs_per_block);
+        std::vector<Pointer> pbuffer;
+        std::vector<hsize_t> order;
+        std::vector<unsigned char> hbuffer;
+        std::vector<hsize_t> offsets(extents.size()), counts(extents);
+
+        for (hsize_t slab = job_start; slab < job_end; slab += slabs_per_block) {
+            hsize_t num = std::min(slabs_per_block, job_end - slab);
+            hsize_t count = num * per_slab;
+            pbuffer.resize(count);
+
+            {
+                std::lock_guard<std::mutex> lck(lock);
+                offsets[0] = slab;
+                counts[0] = num;
+                H5::DataSpace dspace(extents.size(), extents.data());
+                dspace.selectHyperslab(H5S_SELECT_SET, counts.data(), offsets.data());
+                H5::DataSpace mspace(1, &count);
+                pointers.read(pbuffer.data(), ptype, mspace, dspace);
+            }
+
+            bool failed = false;
+            for (hsize_t i = 0; i < count; ++i) {
+                // If 'offset > heap_length', the subtraction wraps around but it doesn't matter as we already failed.
+                failed |= (pbuffer[i].offset > heap_length) | (pbuffer[i].length > heap_length - pbuffer[i].offset);
+            }
+            if (failed) {
+                throw std::runtime_error("VLS array pointers at '" + name + "' are out of range of the heap");
+            }
+
+            if (!check_utf8) {
+                continue;
+            }
+
+            order.resize(count);
+            for (hsize_t i = 0; i < count; ++i) {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&](hsize_t left, hsize_t right) -> bool { return pbuffer[left].offset < pbuffer[right].offset; });
+
+            hsize_t first_invalid = count;
+            hsize_t k = 0;
+            while (k < count) {
+                uint64_t wstart = pbuffer[order[k]].offset;
+                uint64_t wend = wstart + pbuffer[order[k]].length;
+                hsize_t l = k + 1;
+                for (; l < count; ++l) {
+                    const auto& current = pbuffer[order[l]];
+                    uint64_t candidate = std::max(wend, current.offset + current.length);
+                    if (candidate - wstart > window) {
+                        break;
+                    }
+                    wend = candidate;
+                }
+
+                hsize_t wlen = wend - wstart;
+                if (wlen) {
+                    hbuffer.resize(std::max(hbuffer.size(), static_cast<size_t>(wlen)));
+                    std::lock_guard<std::mutex> lck(lock);
+                    H5::DataSpace hspace(1, &heap_length);
+                    hsize_t woffset = wstart;
+                    hspace.selectHyperslab(H5S_SELECT_SET, &wlen, &woffset);
+                    H5::DataSpace wspace(1, &wlen);
+                    heap.read(hbuffer.data(), H5::PredType::NATIVE_UINT8, wspace, hspace);
+                }
+
+                for (; k < l; ++k) {
+                    const auto& current = pbuffer[order[k]];
+                    if (current.length == 0) {
+                        continue;
+                    }
+                    auto ptr = reinterpret_cast<const char*>(hbuffer.data()) + (current.offset - wstart);
+                    auto terminator = static_cast<const char*>(std::memchr(ptr, '\0', current.length));
+                    size_t len = terminator ? static_cast<size_t>(terminator - ptr) : current.length;
+                    if (!internal_utf8::is_valid(ptr, len, instructions)) {
+                        first_invalid = std::min(first_invalid, order[k]);
+                    }
+                }
+            }
+
+            if (first_invalid < count) {
+                throw std::runtime_error("detected an invalid UTF-8 sequence for string " + std::to_string(slab * per_slab + first_invalid) + " in '" + name + "'");
+            }
+        }
+    });
+}
+
+// Call 'fun' with a value-initialized instance of the narrowest native
+// integer type that can represent all values of the on-disk datatype of
+// 'handle', while having the same signedness as 'Default_'. This allows
+// callers to instantiate kernels that operate on data at its native width,
+// rather than converting everything to 'Default_' inside the HDF5 library.
+// Unsigned on-disk types are promoted to the next largest signed type if
+// 'Default_' is signed; 'Default_' itself is used for non-integer types or
+// anything that is not representable by a narrower type.
+template<typename Default_, class Function_>
+auto dispatch_integer_type(const H5::DataSet& handle, Function_ fun) {
+    constexpr bool is_signed = std::is_signed<Default_>::value;
+    typedef typename std::conditional<is_signed, int8_t, uint8_t>::type Type8;
+    typedef typename std::conditional<is_signed, int16_t, uint16_t>::type Type16;
+    typedef typename std::conditional<is_signed, int32_t, uint32_t>::type Type32;
+
+    if (handle.getTypeClass() == H5T_INTEGER) {
+        H5::IntType itype(handle);
+        size_t size = itype.getSize();
+        bool disk_signed = (itype.getSign() != H5T_SGN_NONE);
+
+        bool okay = true;
+        if constexpr(is_signed) {
+            if (!disk_signed) {
+                size *= 2; // need an extra bit to store the largest unsigned values.
+            }
+        } else {
+            okay = !disk_signed;
+        }
+
+        if (okay) {
+            if constexpr(sizeof(Default_) > 1) {
+                if (size <= 1) {
+                    return fun(Type8());
+                }
+            }
+            if constexpr(sizeof(Default_) > 2) {
+                if (size <= 2) {
+                    return fun(Type16());
+                }
+            }
+            if constexpr(sizeof(Default_) > 4) {
+                if (size <= 4) {
+                    return fun(Type32());
+                }
+            }
+        }
+    }
+
+    return fun(Default_());
+}
+
+// Same as iterate_1d_blocks(), but with the in-memory type chosen from the
+// on-disk integer type by dispatch_integer_type(). 'fun' should be a generic
+// callable that accepts a pointer to any of the candidate integer types.
+template<typename Default_, class Function_>
+void iterate_1d_integer_blocks(const H5::DataSet& handle, hsize_t len, hsize_t buffer_size, bool memory_map, Function_ fun) {
+    dispatch_integer_type<Default_>(handle, [&](auto tag) -> void {
+        typedef decltype(tag) Type_;
+        iterate_1d_blocks<Type_>(handle, len, buffer_size, memory_map, fun);
+    });
+}
+
+// Index of the children of a group that are named by their position, i.e.,
+// "0", "1", ..., "n - 1", built from a single pass over the group's links.
+// This avoids a separate lookup for each name when checking for the presence
+// of many children, as well as a separate query for the number of children.
+// We also record the object type of each indexed child during the pass, so
+// that callers do not need another lookup by name to decide how to open it.
+class IndexedChildren {
+public:
+    IndexedChildren(const H5::Group& handle, size_t n) : my_present(n), my_types(n, H5O_TYPE_UNKNOWN) {
+        hsize_t idx = 0;
+        if (H5Literate(handle.getId(), H5_INDEX_NAME, H5_ITER_NATIVE, &idx, &IndexedChildren::collect, this) < 0) {
+            throw std::runtime_error("failed to iterate over the children of '" + ritsuko::hdf5::get_name(handle) + "'");
+        }
+    }
+
+    bool exists(size_t i) const {
+        return my_present[i];
+    }
+
+    // Only meaningful if exists(i) is true. This is H5O_TYPE_UNKNOWN if the
+    // type could not be determined, e.g., for dangling soft links.
+    H5O_type_t type(size_t i) const {
+        return my_types[i];
+    }
+
+    // Total number of children, including those that are not named by position.
+    hsize_t size() const {
+        return my_total;
+    }
+
+private:
+    std::vector<unsigned char> my_present;
+    std::vector<H5O_type_t> my_types;
+    hsize_t my_total = 0;
+
+    static H5O_type_t child_type(hid_t group, const char* name) {
+        herr_t status;
+#if H5_VERSION_GE(1, 12, 0)
+        H5O_info2_t info;
+        H5E_BEGIN_TRY {
+            status = H5Oget_info_by_name3(group, name, &info, H5O_INFO_BASIC, H5P_DEFAULT);
+        } H5E_END_TRY;
+#elif H5_VERSION_GE(1, 10, 3)
+        H5O_info_t info;
+        H5E_BEGIN_TRY {
+            status = H5Oget_info_by_name2(group, name, &info, H5O_INFO_BASIC, H5P_DEFAULT);
+        } H5E_END_TRY;
+#else
+        H5O_info_t info;
+        H5E_BEGIN_TRY {
+            status = H5Oget_info_by_name(group, name, &info, H5P_DEFAULT);
+        } H5E_END_TRY;
+#endif
+        if (status < 0) {
+            return H5O_TYPE_UNKNOWN;
+        }
+        return info.type;
+    }
+
+    // Templated on the link information as its type depends on the HDF5 API version.
+    template<typename Info_>
+    static herr_t collect(hid_t group, const char* name, const Info_*, void* data) {
+        auto self = static_cast<IndexedChildren*>(data);
+        ++(self->my_total);
+
+        // Only accepting canonical decimal representations, i.e., no leading zeros.
+        size_t n = self->my_present.size();
+        if (name[0] == '\0' || (name[0] == '0' && name[1] != '\0')) {
+            return 0;
+        }
+        size_t value = 0;
+        for (const char* ptr = name; *ptr; ++ptr) {
+            if (*ptr < '0' || *ptr > '9') {
+                return 0;
+            }
+            value = value * 10 + (*ptr - '0');
+            if (value >= n) {
+                return 0;
+            }
+        }
+
+        self->my_present[value] = 1;
+        self->my_types[value] = child_type(group, name);
+        return 0;
+    }
+};
+
+// Batch of reads for the same range of multiple 1-dimensional datasets with
+// the same length, typically columns that are being iterated together. On
+// HDF5 1.14 or later, all reads are performed in a single H5Dread_multi()
+// call, which avoids the per-call overhead and allows the library to
+// coalesce I/O across datasets. Otherwise, we fall back to one H5Dread() per
+// dataset. Datasets and buffers should outlive the batch until run().
+class MultiRead {
+public:
+    template<typename Type_>
+    void add(const H5::DataSet& handle, Type_* buffer) {
+        my_datasets.push_back(handle.getId());
+        my_types.push_back(ritsuko::hdf5::as_numeric_datatype<Type_>().getId());
+        my_buffers.push_back(buffer);
+    }
+
+    bool empty() const {
+        return my_datasets.empty();
+    }
+
+    void clear() {
+        my_datasets.clear();
+        my_types.clear();
+        my_buffers.clear();
+    }
+
+    // Reads [start, start + count) from each dataset of length 'len' into its buffer.
+    void run(hsize_t start, hsize_t count, hsize_t len) {
+        if (my_datasets.empty() || count == 0) {
+            return;
+        }
+
+        H5::DataSpace mspace(1, &count);
+        H5::DataSpace fspace(1, &len);
+        fspace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+
+#if H5_VERSION_GE(1, 14, 0)
+        size_t num_datasets = my_datasets.size();
+        std::vector<hid_t> mspaces(num_datasets, mspace.getId()), fspaces(num_datasets, fspace.getId());
+        if (H5Dread_multi(num_datasets, my_datasets.data(), my_types.data(), mspaces.data(), fspaces.data(), H5P_DEFAULT, my_buffers.data()) < 0) {
+            throw std::runtime_error("failed to read multiple HDF5 datasets");
+        }
+#else
+        for (size_t d = 0, end = my_datasets.size(); d < end; ++d) {
+            if (H5Dread(my_datasets[d], my_types[d], mspace.getId(), fspace.getId(), H5P_DEFAULT, my_buffers[d]) < 0) {
+                throw std::runtime_error("failed to read HDF5 dataset");
+            }
+        }
+#endif
+    }
+
+private:
+    std::vector<hid_t> my_datasets, my_types;
+    std::vector<void*> my_buffers;
+};
+
+// Reader for arbitrary ranges of a 1-dimensional dataset that can be used
+// from multiple threads. The dataset is memory-mapped if possible (see
+// map_1d_dataset()), in which case no HDF5 calls are made during iteration.
+// Otherwise, all HDF5 calls are serialized with a mutex, as the library may
+// not have been built to be thread-safe; only 'fun' is run concurrently.
+// If multiple readers are used at the same time, they should be constructed
+// with a shared mutex so that their HDF5 calls are also serialized.
+template<typename Type_>
+class ConcurrentBlockReader {
+public:
+    ConcurrentBlockReader(const H5::DataSet& handle, hsize_t len, bool memory_map) : ConcurrentBlockReader(handle, len, memory_map, my_own_lock) {}
+
+    ConcurrentBlockReader(const H5::DataSet& handle, hsize_t len, bool memory_map, std::mutex& lock) : my_handle(&handle), my_len(len), my_lock(lock) {
+        if (memory_map) {
+            my_mapped = map_1d_dataset<Type_>(handle, len);
+        }
+    }
+
+public:
+    // Calls 'fun(start, count, ptr)' for consecutive blocks of up to
+    // 'buffer_size' elements in [from, to).
+    template<class Function_>
+    void iterate(hsize_t from, hsize_t to, hsize_t buffer_size, Function_ fun) {
+        hsize_t block_size = std::max(buffer_size, static_cast<hsize_t>(1));
+
+        if (my_mapped.mapped()) {
+            auto ptr = reinterpret_cast<const Type_*>(my_mapped.data());
+            for (hsize_t start = from; start < to; start += block_size) {
+                hsize_t count = std::min(block_size, to - start);
+                fun(start, count, ptr + start);
+            }
+            return;
+        }
+
+        block_size = std::min(block_size, to - from);
+        std::vector<Type_> buffer(block_size);
+        Spaces spaces(my_lock);
+        {
+            std::lock_guard<std::mutex> lck(my_lock);
+            spaces.memory.emplace(1, &block_size);
+            spaces.file.emplace(1, &my_len);
+        }
+
+        const auto& mtype = ritsuko::hdf5::as_numeric_datatype<Type_>();
+        constexpr hsize_t zero = 0;
+        for (hsize_t start = from; start < to; start += block_size) {
+            hsize_t count = std::min(block_size, to - start);
+            {
+                std::lock_guard<std::mutex> lck(my_lock);
+                spaces.memory->selectHyperslab(H5S_SELECT_SET, &count, &zero);
+                spaces.file->selectHyperslab(H5S_SELECT_SET, &count, &start);
+                my_handle->read(buffer.data(), mtype, *(spaces.memory), *(spaces.file));
+            }
+            fun(start, count, static_cast<const Type_*>(buffer.data()));
+        }
+    }
+
+    // Returns a pointer to the elements in [start, start + count), either
+    // directly from the mapping or after reading them into 'buffer'.
+    const Type_* fetch(hsize_t start, hsize_t count, std::vector<Type_>& buffer) {
+        if (my_mapped.mapped()) {
+            return reinterpret_cast<const Type_*>(my_mapped.data()) + start;
+        }
+
+        buffer.resize(count);
+        if (count) {
+            std::lock_guard<std::mutex> lck(my_lock);
+            H5::DataSpace mspace(1, &count);
+            H5::DataSpace fspace(1, &my_len);
+            fspace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+            my_handle->read(buffer.data(), ritsuko::hdf5::as_numeric_datatype<Type_>(), mspace, fspace);
+        }
+        return buffer.data();
+    }
+
+    // Same as fetch(), but if the dataset is not mapped, the read into
+    // 'buffer' is deferred by adding it to 'batch'. The returned pointer
+    // should only be used after calling 'batch.run(start, count, len)' while
+    // holding the mutex that was supplied to the constructor.
+    const Type_* fetch(hsize_t start, hsize_t count, std::vector<Type_>& buffer, MultiRead& batch) {
+        if (my_mapped.mapped()) {
+            return reinterpret_cast<const Type_*>(my_mapped.data()) + start;
+        }
+        buffer.resize(count);
+        batch.add(*my_handle, buffer.data());
+        return buffer.data();
+    }
+
+private:
+    const H5::DataSet* my_handle;
+    hsize_t my_len;
+    MappedDataset my_mapped;
+    std::mutex my_own_lock;
+    std::mutex& my_lock;
+
+    // Making sure that the dataspaces are also released under the lock.
+    struct Spaces {
+        Spaces(std::mutex& l) : lock(l) {}
+        ~Spaces() {
+            std::lock_guard<std::mutex> lck(lock);
+            memory.reset();
+            file.reset();
+        }
+        std::mutex& lock;
+        std::optional<H5::DataSpace> memory, file;
+    };
+};
+
+// Block-parallel reduction over a 1-dimensional dataset. Each job processes a
+// contiguous range of blocks of up to 'buffer_size' elements, starting from
+// 'initial' and updating its value with 'combine(value, start, count, ptr)'
+// for each block. The values from all jobs are then merged in order with
+// 'merge(left, right)'; as jobs are also ordered, any error thrown by
+// 'combine' is the same as that from a serial pass over the dataset.
+template<typename Type_, typename Value_, class Combine_, class Merge_>
+Value_ reduce_1d_blocks(const H5::DataSet& handle, hsize_t len, hsize_t buffer_size, int num_threads, bool memory_map, Value_ initial, Combine_ combine, Merge_ merge) {
+    ConcurrentBlockReader<Type_> reader(handle, len, memory_map);
+
+    hsize_t block_size = std::max(buffer_size, static_cast<hsize_t>(1));
+    hsize_t num_blocks = (len + block_size - 1) / block_size;
+    size_t num_jobs = (num_threads > 1 ? std::min(static_cast<hsize_t>(num_threads) * 4, num_blocks) : 1);
+    hsize_t blocks_per_job = (num_jobs ? (num_blocks + num_jobs - 1) / num_jobs : 0);
+    std::vector<Value_> partials(num_jobs, initial);
+
+    internal_parallel::parallelize(num_jobs, num_threads, [&](size_t job) -> void {
+        hsize_t job_start = std::min(len, job * blocks_per_job * block_size);
+        hsize_t job_end = std::min(len, job_start + blocks_per_job * block_size);
+        auto& current = partials[job];
+        if (job_start < job_end) {
+            reader.iterate(job_start, job_end, block_size, [&](hsize_t start, hsize_t count, const Type_* ptr) -> void {
+                current = combine(current, start, count, ptr);
+            });
+        }
+    });
+
+    Value_ output = initial;
+    for (const auto& p : partials) {
+        output = merge(output, p);
+    }
+    return output;
+}
+
+// Sum of a 1-dimensional dataset of unsigned integers, computed in parallel
+// with the vectorized kernel at the native width of the on-disk type. No
+// value is returned if the sum overflows a 64-bit unsigned integer.
+inline std::optional<uint64_t> sum_1d_integers(const H5::DataSet& handle, hsize_t len, hsize_t buffer_size, int num_threads, bool memory_map) {
+    typedef std::optional<uint64_t> Sum;
+    auto instructions = internal_simd::available_instructions();
+    return dispatch_integer_type<uint64_t>(handle, [&](auto tag) -> Sum {
+        typedef decltype(tag) Type_;
+        return reduce_1d_blocks<Type_>(
+            handle,
+            len,
+            buffer_size,
+            num_threads,
+            memory_map,
+            Sum(0),
+            [&](const Sum& current, hsize_t, hsize_t count, const Type_* ptr) -> Sum {
+                if (!current.has_value()) {
+                    return current;
+                }
+                uint64_t total = *current;
+                if (!internal_simd::checked_sum(ptr, count, total, instructions)) {
+                    return Sum();
+                }
+                return Sum(total);
+            },
+            [](const Sum& left, const Sum& right) -> Sum {
+                if (!left.has_value() || !right.has_value()) {
+                    return Sum();
+                }
+                uint64_t total = *left + *right;
+                if (total < *left) {
+                    return Sum();
+                }
+                return Sum(total);
+            }
+        );
+    });
+}
+
+}
+
+}
+
+#endif
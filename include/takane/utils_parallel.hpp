@@ -0,0 +1,141 @@
+#ifndef TAKANE_UTILS_PARALLEL_HPP
+#define TAKANE_UTILS_PARALLEL_HPP
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "H5Cpp.h"
+
+#include "utils_public.hpp"
+
+namespace takane {
+
+namespace internal_parallel {
+
+// Run 'fun(job)' for each 'job' in [0, num_jobs) across up to 'num_threads'
+// threads. Jobs are started in increasing order, so if a job throws, any job
+// with a larger index that has not yet started is skipped. Once all threads
+// are finished, the exception from the lowest-indexed failing job is rethrown;
+// if each job processes a contiguous range of elements in order, this is the
+// same error that would have been reported by a serial loop over the jobs.
+template<class Function_>
+void parallelize(size_t num_jobs, int num_threads, Function_ fun) {
+    size_t nthreads = std::min(static_cast<size_t>(std::max(num_threads, 1)), num_jobs);
+    if (nthreads <= 1) {
+        for (size_t j = 0; j < num_jobs; ++j) {
+            fun(j);
+        }
+        return;
+    }
+
+    constexpr size_t no_failure = std::numeric_limits<size_t>::max();
+    std::atomic<size_t> next(0), first_failure(no_failure);
+    std::vector<std::exception_ptr> errors(num_jobs);
+
+    auto worker = [&]() -> void {
+        while (true) {
+            size_t j = next.fetch_add(1);
+            if (j >= num_jobs || first_failure.load() < j) {
+                return;
+            }
+
+            try {
+                fun(j);
+            } catch (...) {
+                errors[j] = std::current_exception();
+                size_t current = first_failure.load();
+                while (j < current && !first_failure.compare_exchange_weak(current, j)) {}
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(nthreads - 1);
+    for (size_t t = 1; t < nthreads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    size_t failed = first_failure.load();
+    if (failed != no_failure) {
+        std::rethrow_exception(errors[failed]);
+    }
+}
+
+// Override for hdf5_is_threadsafe(), only intended for testing the parallel
+// code paths with functions that do not call the HDF5 library.
+inline std::optional<bool>& hdf5_threadsafe_override() {
+    static std::optional<bool> value;
+    return value;
+}
+
+// Whether the HDF5 library was built to be thread-safe, in which case it can be
+// called from multiple threads as it serializes all calls with its own lock.
+inline bool hdf5_is_threadsafe() {
+    const auto& override = hdf5_threadsafe_override();
+    if (override.has_value()) {
+        return *override;
+    }
+
+    static const bool threadsafe = []() -> bool {
+        hbool_t output = false;
+        if (H5is_library_threadsafe(&output) < 0) {
+            return false;
+        }
+        return output;
+    }();
+    return threadsafe;
+}
+
+// Whether child objects can be validated concurrently in parallelize_objects().
+// This is opt-in as HDF5's C++ API is not supported in thread-safe builds.
+inline bool can_parallelize_objects(const Options& options) {
+    return options.parallel_objects && options.num_threads > 1 && hdf5_is_threadsafe();
+}
+
+// Run 'fun(i, object_options)' for each child object 'i' in [0, num_objects),
+// where 'object_options' is the Options to use for validating that object.
+// If permitted, objects are processed concurrently in contiguous jobs. Each
+// job gets its own copy of the options, with the threads split between the
+// concurrent objects; all copies share the caller's session cache, if any.
+// As in parallelize(), this reports the error from the lowest-indexed
+// failing object, same as a serial loop.
+template<class Function_>
+void parallelize_objects(size_t num_objects, Options& options, Function_ fun) {
+    if (num_objects <= 1 || !can_parallelize_objects(options)) {
+        for (size_t i = 0; i < num_objects; ++i) {
+            fun(i, options);
+        }
+        return;
+    }
+
+    // Using a few jobs per thread for load balancing, while avoiding a copy of the options for every object.
+    size_t num_jobs = std::min(num_objects, static_cast<size_t>(options.num_threads) * 4);
+    int num_concurrent = std::min(static_cast<size_t>(options.num_threads), num_objects);
+    int threads_per_object = std::max(1, options.num_threads / num_concurrent);
+
+    parallelize(num_jobs, options.num_threads, [&](size_t job) -> void {
+        Options object_options = options;
+        object_options.num_threads = threads_per_object;
+        size_t start = (num_objects * job) / num_jobs, end = (num_objects * (job + 1)) / num_jobs;
+        for (size_t i = start; i < end; ++i) {
+            fun(i, object_options);
+        }
+    });
+}
+
+}
+
+}
+
+#endif
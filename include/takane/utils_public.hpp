@@ -5,12 +5,14 @@
 #include <filesystem>
 #include <unordered_map>
 #include <functional>
+#include <memory>
 
 #include "H5Cpp.h"
 
 #include "millijson/millijson.hpp"
 #include "chihaya/chihaya.hpp"
 #include "utils_json.hpp"
+#include "utils_cache.hpp"
 
 /**
  * @file utils_public.hpp
@@ -85,6 +87,7 @@ inline ObjectMetadata read_object_metadata(const std::filesystem::path& path) tr
  *
  * Most **takane** functions will accept a non-`const` reference to an `Options` object.
  * The lack of `const`-ness is intended to support custom functions that mutate some external variable, e.g., to collect statistics for certain object types.
+ * Note that such functions may be called concurrently if `Options::parallel_objects` is enabled.
  * While unusual, it is permissible for a **takane** function to modify the supplied `Options`, as long as that modification is reversed upon exiting the function.
  *
  * The possibility for modification means that calls to **takane** functions are effectively `const` but not thread-safe with respect to any single `Options` instance.
@@ -95,12 +98,82 @@ struct Options {
      * Whether to parallelize reading from disk and parsing, when available.
      */
     bool parallel_reads = true;
+
+    /**
+     * Number of threads to use for validating the contents of large datasets, for those object types that support parallelization.
+     * Calls to the HDF5 library are still serialized so this only parallelizes the checks on the loaded values.
+     *
+     * If `parallel_objects = true`, this is also used to validate child objects in parallel, see `parallel_objects` for details.
+     * The file signatures of PNG and TIFF images in a spatial experiment are always checked in parallel, as these checks do not involve the HDF5 library or any custom functions.
+     */
+    int num_threads = 1;
+
+    /**
+     * Whether to validate child objects in parallel when `num_threads` is greater than 1.
+     * This is only performed if the HDF5 library was built to be thread-safe.
+     * Even then, it is disabled by default as HDF5 does not support concurrent use of its C++ API in thread-safe builds.
+     * The HDF5 error stack and automatic error printing are also thread-specific, so settings in the calling thread do not apply to the worker threads.
+     * Applications should only enable this option if their HDF5 build is known to tolerate concurrent calls via the C++ API.
+     *
+     * If enabled, `validate()`, `height()`, `dimensions()`, `satisfies_interface()` and `derived_from()` may be called concurrently for:
+     *
+     * - the columns of a data frame.
+     * - the experiments in a multi-sample dataset.
+     * - the seeds of a delayed array.
+     * - the components of a summarized experiment and its derived types, i.e., the assays, row data, column data, other data, row ranges, reduced dimensions, alternative experiments, spatial coordinates and spatial images.
+     *
+     * In such cases, each concurrent call uses a separate copy of the `Options`, and any custom functions in this object (e.g., `custom_validate`, `custom_global_validate`, `custom_dimensions`, `custom_height`, or the various `*_strict_check` functions) may be called from multiple threads at once.
+     * Custom functions that mutate some external variable should protect it with a mutex or similar.
+     */
+    bool parallel_objects = false;
     
     /**
      * Buffer size to use when reading data from a HDF5 file.
      */
     hsize_t hdf5_buffer_size = 10000;
 
+    /**
+     * Whether to memory-map the contents of HDF5 datasets that are stored contiguously without any filters.
+     * This avoids copying data through the HDF5 library when the on-disk datatype is the same as the in-memory representation used for validation.
+     * Otherwise, if mapping is not possible (or this option is `false`), datasets are read in blocks of size `hdf5_buffer_size`.
+     * Mapping is only performed on POSIX systems for files that are opened read-only with HDF5's default file driver.
+     */
+    bool hdf5_memory_map = true;
+
+    /**
+     * Maximum memory (in bytes) to use for holding the pointers of a compressed sparse matrix in `compressed_sparse_matrix::validate()`.
+     * If the pointers would exceed this limit, they are streamed alongside the indices instead of being loaded into memory.
+     * This keeps memory usage independent of the primary dimension extent but precludes parallel validation of the indices (see `num_threads`).
+     */
+    size_t compressed_sparse_matrix_indptr_memory_limit = 1073741824;
+
+    /**
+     * Whether to check that the contents of all strings are valid UTF-8, e.g., in string columns, names, factor levels and VLS arrays.
+     * By default, only the datatypes of string datasets are checked for UTF-8 compatibility, without inspecting the bytes of each string.
+     * Setting this to `true` will throw an error for any malformed sequence, including overlong encodings and surrogates.
+     */
+    bool validate_utf8 = false;
+
+    /**
+     * Whether to cache intermediate results that can be re-used across objects in a single validation session, e.g., the sequence information shared by many genomic ranges.
+     * A session corresponds to a single top-level call to `validate()`, `height()` or `dimensions()`; the cache is discarded afterwards, so nothing is retained between calls.
+     * Cached results are keyed by the full contents of the relevant files and by any options that affect the result (e.g., `validate_utf8`), so a stale result will not be used if those files change.
+     * The exception is the dimensions of delayed arrays, which are keyed by the path, size, modification time and (on POSIX systems) the device and inode of `array.h5`, so that parent objects can query the dimensions of a validated delayed array without reading the file again.
+     * Caching is not performed for objects with a custom function in `custom_validate` or if `custom_global_validate` is set, as these functions might have side effects.
+     */
+    bool cache_results = true;
+
+    /**
+     * @cond
+     */
+    // Created by the top-level validate(), height() or dimensions() call and
+    // shared between copies of this object. A cache supplied by the caller is
+    // left in place, so that it can be re-used across calls if desired.
+    std::shared_ptr<internal_cache::SessionCache> session_cache;
+    /**
+     * @endcond
+     */
+
 public:
     /**
      * Custom registry of functions to be used by `validate()`.
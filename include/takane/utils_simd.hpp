@@ -0,0 +1,647 @@
+#ifndef TAKANE_UTILS_SIMD_HPP
+#define TAKANE_UTILS_SIMD_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TAKANE_SIMD_X86 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TAKANE_SIMD_NEON 1
+#endif
+
+namespace takane {
+
+namespace internal_simd {
+
+enum class Instructions : char { NONE, AVX2, AVX512, NEON };
+
+// Instruction set to use for the kernels below. On x86, this is determined
+// at runtime so that the library does not need to be compiled with -mavx2,
+// etc. NEON is always available on AArch64.
+inline Instructions available_instructions() {
+#if defined(TAKANE_SIMD_X86)
+    static const Instructions chosen = []() -> Instructions {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+            return Instructions::AVX512;
+        } else if (__builtin_cpu_supports("avx2")) {
+            return Instructions::AVX2;
+        } else {
+            return Instructions::NONE;
+        }
+    }();
+    return chosen;
+#elif defined(TAKANE_SIMD_NEON)
+    return Instructions::NEON;
+#else
+    return Instructions::NONE;
+#endif
+}
+
+// All kernels find the first position 'i' in [from, n) where 'x[i] > max_allowed'
+// or 'x[i] <= x[i - 1]', returning 'n' if no such position exists. 'from'
+// should be positive so that 'x[from - 1]' can be used as the first comparison.
+template<typename Type_>
+size_t find_unsorted_or_out_of_range_scalar(const Type_* x, size_t from, size_t n, Type_ max_allowed) {
+    // Accumulating flags without branching in each block, so that the compiler has a chance to vectorize it.
+    constexpr size_t block_size = 16;
+    size_t i = from;
+    for (; i + block_size <= n; i += block_size) {
+        bool failed = false;
+        for (size_t j = i; j < i + block_size; ++j) {
+            failed |= (x[j] > max_allowed) | (x[j] <= x[j - 1]);
+        }
+        if (failed) {
+            break;
+        }
+    }
+
+    for (; i < n; ++i) {
+        if (x[i] > max_allowed || x[i] <= x[i - 1]) {
+            return i;
+        }
+    }
+    return n;
+}
+
+#if defined(TAKANE_SIMD_X86)
+template<typename Type_>
+__attribute__((target("avx2")))
+size_t find_unsorted_or_out_of_range_avx2(const Type_* x, size_t from, size_t n, Type_ max_allowed) {
+    constexpr size_t width = 32 / sizeof(Type_);
+    size_t i = from;
+
+    if constexpr(sizeof(Type_) == 8) {
+        // No unsigned 64-bit comparisons in AVX2, so we flip the sign bit and use signed comparisons.
+        const __m256i flip = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+        const __m256i limit = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(max_allowed)), flip);
+        for (; i + width <= n; i += width) {
+            __m256i current = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)), flip);
+            __m256i previous = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i - 1)), flip);
+            __m256i okay = _mm256_andnot_si256(_mm256_cmpgt_epi64(current, limit), _mm256_cmpgt_epi64(current, previous));
+            uint32_t failed = ~static_cast<uint32_t>(_mm256_movemask_epi8(okay));
+            if (failed) {
+                return i + __builtin_ctz(failed) / sizeof(Type_);
+            }
+        }
+
+    } else {
+        // For smaller types, 'a <= b' is equivalent to 'max(a, b) == b'.
+        __m256i limit;
+        if constexpr(sizeof(Type_) == 1) {
+            limit = _mm256_set1_epi8(static_cast<char>(max_allowed));
+        } else if constexpr(sizeof(Type_) == 2) {
+            limit = _mm256_set1_epi16(static_cast<short>(max_allowed));
+        } else {
+            limit = _mm256_set1_epi32(static_cast<int>(max_allowed));
+        }
+
+        for (; i + width <= n; i += width) {
+            __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i - 1));
+            __m256i okay;
+            if constexpr(sizeof(Type_) == 1) {
+                okay = _mm256_andnot_si256(
+                    _mm256_cmpeq_epi8(_mm256_max_epu8(current, previous), previous),
+                    _mm256_cmpeq_epi8(_mm256_max_epu8(current, limit), limit)
+                );
+            } else if constexpr(sizeof(Type_) == 2) {
+                okay = _mm256_andnot_si256(
+                    _mm256_cmpeq_epi16(_mm256_max_epu16(current, previous), previous),
+                    _mm256_cmpeq_epi16(_mm256_max_epu16(current, limit), limit)
+                );
+            } else {
+                okay = _mm256_andnot_si256(
+                    _mm256_cmpeq_epi32(_mm256_max_epu32(current, previous), previous),
+                    _mm256_cmpeq_epi32(_mm256_max_epu32(current, limit), limit)
+                );
+            }
+
+            uint32_t failed = ~static_cast<uint32_t>(_mm256_movemask_epi8(okay));
+            if (failed) {
+                return i + __builtin_ctz(failed) / sizeof(Type_);
+            }
+        }
+    }
+
+    return find_unsorted_or_out_of_range_scalar(x, i, n, max_allowed);
+}
+
+template<typename Type_>
+__attribute__((target("avx512f,avx512bw")))
+size_t find_unsorted_or_out_of_range_avx512(const Type_* x, size_t from, size_t n, Type_ max_allowed) {
+    constexpr size_t width = 64 / sizeof(Type_);
+    size_t i = from;
+
+    for (; i + width <= n; i += width) {
+        __m512i current = _mm512_loadu_si512(x + i);
+        __m512i previous = _mm512_loadu_si512(x + i - 1);
+        uint64_t failed;
+        if constexpr(sizeof(Type_) == 1) {
+            __m512i limit = _mm512_set1_epi8(static_cast<char>(max_allowed));
+            failed = _mm512_cmpgt_epu8_mask(current, limit) | _mm512_cmple_epu8_mask(current, previous);
+        } else if constexpr(sizeof(Type_) == 2) {
+            __m512i limit = _mm512_set1_epi16(static_cast<short>(max_allowed));
+            failed = _mm512_cmpgt_epu16_mask(current, limit) | _mm512_cmple_epu16_mask(current, previous);
+        } else if constexpr(sizeof(Type_) == 4) {
+            __m512i limit = _mm512_set1_epi32(static_cast<int>(max_allowed));
+            failed = _mm512_cmpgt_epu32_mask(current, limit) | _mm512_cmple_epu32_mask(current, previous);
+        } else {
+            __m512i limit = _mm512_set1_epi64(static_cast<long long>(max_allowed));
+            failed = _mm512_cmpgt_epu64_mask(current, limit) | _mm512_cmple_epu64_mask(current, previous);
+        }
+        if (failed) {
+            return i + __builtin_ctzll(failed);
+        }
+    }
+
+    return find_unsorted_or_out_of_range_scalar(x, i, n, max_allowed);
+}
+#endif
+
+#if defined(TAKANE_SIMD_NEON)
+template<typename Type_>
+size_t find_unsorted_or_out_of_range_neon(const Type_* x, size_t from, size_t n, Type_ max_allowed) {
+    constexpr size_t width = 16 / sizeof(Type_);
+    size_t i = from;
+
+    for (; i + width <= n; i += width) {
+        uint32x4_t failed;
+        if constexpr(sizeof(Type_) == 1) {
+            uint8x16_t current = vld1q_u8(x + i), previous = vld1q_u8(x + i - 1);
+            failed = vreinterpretq_u32_u8(vorrq_u8(vcgtq_u8(current, vdupq_n_u8(max_allowed)), vcleq_u8(current, previous)));
+        } else if constexpr(sizeof(Type_) == 2) {
+            uint16x8_t current = vld1q_u16(x + i), previous = vld1q_u16(x + i - 1);
+            failed = vreinterpretq_u32_u16(vorrq_u16(vcgtq_u16(current, vdupq_n_u16(max_allowed)), vcleq_u16(current, previous)));
+        } else if constexpr(sizeof(Type_) == 4) {
+            uint32x4_t current = vld1q_u32(x + i), previous = vld1q_u32(x + i - 1);
+            failed = vorrq_u32(vcgtq_u32(current, vdupq_n_u32(max_allowed)), vcleq_u32(current, previous));
+        } else {
+            uint64x2_t current = vld1q_u64(x + i), previous = vld1q_u64(x + i - 1);
+            failed = vreinterpretq_u32_u64(vorrq_u64(vcgtq_u64(current, vdupq_n_u64(max_allowed)), vcleq_u64(current, previous)));
+        }
+
+        // Falling back to the scalar loop to find the exact position.
+        if (vmaxvq_u32(failed)) {
+            return find_unsorted_or_out_of_range_scalar(x, i, i + width, max_allowed);
+        }
+    }
+
+    return find_unsorted_or_out_of_range_scalar(x, i, n, max_allowed);
+}
+#endif
+
+template<typename Type_>
+size_t find_unsorted_or_out_of_range(const Type_* x, size_t from, size_t n, Type_ max_allowed, Instructions instructions = available_instructions()) {
+    static_assert(std::is_unsigned<Type_>::value);
+
+    switch (instructions) {
+#if defined(TAKANE_SIMD_X86)
+        case Instructions::AVX512:
+            return find_unsorted_or_out_of_range_avx512(x, from, n, max_allowed);
+        case Instructions::AVX2:
+            return find_unsorted_or_out_of_range_avx2(x, from, n, max_allowed);
+#endif
+#if defined(TAKANE_SIMD_NEON)
+        case Instructions::NEON:
+            return find_unsorted_or_out_of_range_neon(x, from, n, max_allowed);
+#endif
+        default:
+            break;
+    }
+
+    return find_unsorted_or_out_of_range_scalar(x, from, n, max_allowed);
+}
+
+
+// All kernels compute the maximum of 'x' in [0, n) after masking all values
+// equal to 'placeholder' to zero, i.e., the largest non-placeholder value.
+// Zero is returned if 'n = 0' or all values are equal to the placeholder. If
+// there is no placeholder, callers can set it to zero, which does not affect
+// the maximum. This is intended for a quick check that all values are below an
+// upper bound, only falling back to a slower loop to locate any offending value.
+template<typename Type_>
+Type_ masked_max_scalar(const Type_* x, size_t n, Type_ placeholder) {
+    Type_ output = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Type_ current = (x[i] == placeholder ? 0 : x[i]);
+        output = (current > output ? current : output);
+    }
+    return output;
+}
+
+#if defined(TAKANE_SIMD_X86)
+template<typename Type_, size_t width_>
+Type_ reduce_max(const Type_* lanes) {
+    Type_ output = 0;
+    for (size_t l = 0; l < width_; ++l) {
+        output = (lanes[l] > output ? lanes[l] : output);
+    }
+    return output;
+}
+
+template<typename Type_>
+__attribute__((target("avx2")))
+Type_ masked_max_avx2(const Type_* x, size_t n, Type_ placeholder) {
+    constexpr size_t width = 32 / sizeof(Type_);
+    size_t i = 0;
+    __m256i accumulated = _mm256_setzero_si256();
+
+    if constexpr(sizeof(Type_) == 8) {
+        // No unsigned 64-bit maximum in AVX2, so we flip the sign bit for a signed comparison and blend.
+        const __m256i flip = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+        const __m256i ph = _mm256_set1_epi64x(static_cast<long long>(placeholder));
+        for (; i + width <= n; i += width) {
+            __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            current = _mm256_andnot_si256(_mm256_cmpeq_epi64(current, ph), current);
+            __m256i larger = _mm256_cmpgt_epi64(_mm256_xor_si256(current, flip), _mm256_xor_si256(accumulated, flip));
+            accumulated = _mm256_blendv_epi8(accumulated, current, larger);
+        }
+
+    } else {
+        __m256i ph;
+        if constexpr(sizeof(Type_) == 1) {
+            ph = _mm256_set1_epi8(static_cast<char>(placeholder));
+        } else if constexpr(sizeof(Type_) == 2) {
+            ph = _mm256_set1_epi16(static_cast<short>(placeholder));
+        } else {
+            ph = _mm256_set1_epi32(static_cast<int>(placeholder));
+        }
+
+        for (; i + width <= n; i += width) {
+            __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            if constexpr(sizeof(Type_) == 1) {
+                accumulated = _mm256_max_epu8(accumulated, _mm256_andnot_si256(_mm256_cmpeq_epi8(current, ph), current));
+            } else if constexpr(sizeof(Type_) == 2) {
+                accumulated = _mm256_max_epu16(accumulated, _mm256_andnot_si256(_mm256_cmpeq_epi16(current, ph), current));
+            } else {
+                accumulated = _mm256_max_epu32(accumulated, _mm256_andnot_si256(_mm256_cmpeq_epi32(current, ph), current));
+            }
+        }
+    }
+
+    Type_ lanes[width];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), accumulated);
+    Type_ output = reduce_max<Type_, width>(lanes);
+    Type_ leftover = masked_max_scalar(x + i, n - i, placeholder);
+    return (leftover > output ? leftover : output);
+}
+
+template<typename Type_>
+__attribute__((target("avx512f,avx512bw")))
+Type_ masked_max_avx512(const Type_* x, size_t n, Type_ placeholder) {
+    constexpr size_t width = 64 / sizeof(Type_);
+    size_t i = 0;
+    __m512i accumulated = _mm512_setzero_si512();
+
+    for (; i + width <= n; i += width) {
+        __m512i current = _mm512_loadu_si512(x + i);
+        if constexpr(sizeof(Type_) == 1) {
+            auto keep = _mm512_cmpneq_epu8_mask(current, _mm512_set1_epi8(static_cast<char>(placeholder)));
+            accumulated = _mm512_mask_max_epu8(accumulated, keep, accumulated, current);
+        } else if constexpr(sizeof(Type_) == 2) {
+            auto keep = _mm512_cmpneq_epu16_mask(current, _mm512_set1_epi16(static_cast<short>(placeholder)));
+            accumulated = _mm512_mask_max_epu16(accumulated, keep, accumulated, current);
+        } else if constexpr(sizeof(Type_) == 4) {
+            auto keep = _mm512_cmpneq_epu32_mask(current, _mm512_set1_epi32(static_cast<int>(placeholder)));
+            accumulated = _mm512_mask_max_epu32(accumulated, keep, accumulated, current);
+        } else {
+            auto keep = _mm512_cmpneq_epu64_mask(current, _mm512_set1_epi64(static_cast<long long>(placeholder)));
+            accumulated = _mm512_mask_max_epu64(accumulated, keep, accumulated, current);
+        }
+    }
+
+    Type_ lanes[width];
+    _mm512_storeu_si512(lanes, accumulated);
+    Type_ output = reduce_max<Type_, width>(lanes);
+    Type_ leftover = masked_max_scalar(x + i, n - i, placeholder);
+    return (leftover > output ? leftover : output);
+}
+#endif
+
+#if defined(TAKANE_SIMD_NEON)
+template<typename Type_>
+Type_ masked_max_neon(const Type_* x, size_t n, Type_ placeholder) {
+    constexpr size_t width = 16 / sizeof(Type_);
+    size_t i = 0;
+    Type_ output;
+
+    if constexpr(sizeof(Type_) == 1) {
+        uint8x16_t accumulated = vdupq_n_u8(0), ph = vdupq_n_u8(placeholder);
+        for (; i + width <= n; i += width) {
+            uint8x16_t current = vld1q_u8(x + i);
+            accumulated = vmaxq_u8(accumulated, vbicq_u8(current, vceqq_u8(current, ph)));
+        }
+        output = vmaxvq_u8(accumulated);
+    } else if constexpr(sizeof(Type_) == 2) {
+        uint16x8_t accumulated = vdupq_n_u16(0), ph = vdupq_n_u16(placeholder);
+        for (; i + width <= n; i += width) {
+            uint16x8_t current = vld1q_u16(x + i);
+            accumulated = vmaxq_u16(accumulated, vbicq_u16(current, vceqq_u16(current, ph)));
+        }
+        output = vmaxvq_u16(accumulated);
+    } else if constexpr(sizeof(Type_) == 4) {
+        uint32x4_t accumulated = vdupq_n_u32(0), ph = vdupq_n_u32(placeholder);
+        for (; i + width <= n; i += width) {
+            uint32x4_t current = vld1q_u32(x + i);
+            accumulated = vmaxq_u32(accumulated, vbicq_u32(current, vceqq_u32(current, ph)));
+        }
+        output = vmaxvq_u32(accumulated);
+    } else {
+        // No 64-bit maximum, so we compare and select instead.
+        uint64x2_t accumulated = vdupq_n_u64(0), ph = vdupq_n_u64(placeholder);
+        for (; i + width <= n; i += width) {
+            uint64x2_t current = vld1q_u64(x + i);
+            current = vbicq_u64(current, vceqq_u64(current, ph));
+            accumulated = vbslq_u64(vcgtq_u64(current, accumulated), current, accumulated);
+        }
+        Type_ first = vgetq_lane_u64(accumulated, 0), second = vgetq_lane_u64(accumulated, 1);
+        output = (first > second ? first : second);
+    }
+
+    Type_ leftover = masked_max_scalar(x + i, n - i, placeholder);
+    return (leftover > output ? leftover : output);
+}
+#endif
+
+template<typename Type_>
+Type_ masked_max(const Type_* x, size_t n, Type_ placeholder, Instructions instructions = available_instructions()) {
+    static_assert(std::is_unsigned<Type_>::value);
+
+    switch (instructions) {
+#if defined(TAKANE_SIMD_X86)
+        case Instructions::AVX512:
+            return masked_max_avx512(x, n, placeholder);
+        case Instructions::AVX2:
+            return masked_max_avx2(x, n, placeholder);
+#endif
+#if defined(TAKANE_SIMD_NEON)
+        case Instructions::NEON:
+            return masked_max_neon(x, n, placeholder);
+#endif
+        default:
+            break;
+    }
+
+    return masked_max_scalar(x, n, placeholder);
+}
+
+// All kernels find the first position 'i' in [0, n) where 'x[i]' is not an
+// ASCII character, i.e., its most significant bit is set, returning 'n' if no
+// such position exists. This is used to skip over runs of ASCII characters
+// when validating UTF-8, which should be the vast majority of most strings.
+inline size_t find_non_ascii_scalar(const char* x, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, x + i, 8);
+        if (word & 0x8080808080808080ull) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        if (static_cast<unsigned char>(x[i]) & 0x80) {
+            return i;
+        }
+    }
+    return n;
+}
+
+#if defined(TAKANE_SIMD_X86)
+__attribute__((target("avx2")))
+inline size_t find_non_ascii_avx2(const char* x, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        auto current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        uint32_t mask = _mm256_movemask_epi8(current);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + find_non_ascii_scalar(x + i, n - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline size_t find_non_ascii_avx512(const char* x, size_t n) {
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        auto current = _mm512_loadu_si512(reinterpret_cast<const void*>(x + i));
+        uint64_t mask = _mm512_movepi8_mask(current);
+        if (mask) {
+            return i + __builtin_ctzll(mask);
+        }
+    }
+    return i + find_non_ascii_scalar(x + i, n - i);
+}
+#endif
+
+#if defined(TAKANE_SIMD_NEON)
+inline size_t find_non_ascii_neon(const char* x, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t current = vld1q_u8(reinterpret_cast<const uint8_t*>(x + i));
+        if (vmaxvq_u8(current) & 0x80) {
+            return i + find_non_ascii_scalar(x + i, 16);
+        }
+    }
+    return i + find_non_ascii_scalar(x + i, n - i);
+}
+#endif
+
+inline size_t find_non_ascii(const char* x, size_t n, Instructions instructions = available_instructions()) {
+    switch (instructions) {
+#if defined(TAKANE_SIMD_X86)
+        case Instructions::AVX512:
+            return find_non_ascii_avx512(x, n);
+        case Instructions::AVX2:
+            return find_non_ascii_avx2(x, n);
+#endif
+#if defined(TAKANE_SIMD_NEON)
+        case Instructions::NEON:
+            return find_non_ascii_neon(x, n);
+#endif
+        default:
+            break;
+    }
+
+    return find_non_ascii_scalar(x, n);
+}
+
+// All kernels add the sum of 'x' in [0, n) to 'total', returning false if
+// the sum overflows a 64-bit unsigned integer (in which case 'total' is
+// unspecified). Each lane keeps its own running sum and records whether it
+// ever wrapped around, which is only possible if the full sum also overflows;
+// the lanes are then combined with a checked scalar addition at the end.
+// Narrower unsigned types are zero-extended into 64-bit lanes on load, so
+// that datasets can be summed at their native on-disk width.
+template<typename Type_>
+bool checked_sum_scalar(const Type_* x, size_t n, uint64_t& total) {
+    static_assert(std::is_unsigned<Type_>::value);
+    uint64_t current = total;
+    bool overflow = false;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t next = current + static_cast<uint64_t>(x[i]);
+        overflow |= (next < current);
+        current = next;
+    }
+    total = current;
+    return !overflow;
+}
+
+template<size_t width_>
+bool checked_reduce(const uint64_t* lanes, uint64_t& total) {
+    return checked_sum_scalar(lanes, width_, total);
+}
+
+#if defined(TAKANE_SIMD_X86)
+// Load 4 values from 'x', zero-extended to 64 bits.
+template<typename Type_>
+__attribute__((target("avx2")))
+__m256i load_widened_avx2(const Type_* x) {
+    if constexpr(sizeof(Type_) == 8) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x));
+    } else if constexpr(sizeof(Type_) == 4) {
+        return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+    } else if constexpr(sizeof(Type_) == 2) {
+        return _mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(x)));
+    } else {
+        int32_t bytes;
+        std::memcpy(&bytes, x, 4);
+        return _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes));
+    }
+}
+
+template<typename Type_>
+__attribute__((target("avx2")))
+bool checked_sum_avx2(const Type_* x, size_t n, uint64_t& total) {
+    constexpr size_t width = 4;
+    size_t i = 0;
+    __m256i accumulated = _mm256_setzero_si256(), carried = _mm256_setzero_si256();
+
+    // No unsigned 64-bit comparison in AVX2, so we flip the sign bit for a signed comparison.
+    const __m256i flip = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+    for (; i + width <= n; i += width) {
+        __m256i current = load_widened_avx2(x + i);
+        __m256i next = _mm256_add_epi64(accumulated, current);
+        carried = _mm256_or_si256(carried, _mm256_cmpgt_epi64(_mm256_xor_si256(accumulated, flip), _mm256_xor_si256(next, flip)));
+        accumulated = next;
+    }
+
+    uint64_t lanes[width];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), accumulated);
+    bool okay = _mm256_testz_si256(carried, carried);
+    okay &= checked_reduce<width>(lanes, total);
+    okay &= checked_sum_scalar(x + i, n - i, total);
+    return okay;
+}
+
+// Load 8 values from 'x', zero-extended to 64 bits. We use the zero-masked
+// conversions with a full mask, as the unmasked versions trigger spurious
+// -Wmaybe-uninitialized warnings in some versions of GCC.
+template<typename Type_>
+__attribute__((target("avx512f")))
+__m512i load_widened_avx512(const Type_* x) {
+    constexpr __mmask8 all = 0xFF;
+    if constexpr(sizeof(Type_) == 8) {
+        return _mm512_loadu_si512(x);
+    } else if constexpr(sizeof(Type_) == 4) {
+        return _mm512_maskz_cvtepu32_epi64(all, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)));
+    } else if constexpr(sizeof(Type_) == 2) {
+        return _mm512_maskz_cvtepu16_epi64(all, _mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+    } else {
+        return _mm512_maskz_cvtepu8_epi64(all, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(x)));
+    }
+}
+
+template<typename Type_>
+__attribute__((target("avx512f")))
+bool checked_sum_avx512(const Type_* x, size_t n, uint64_t& total) {
+    constexpr size_t width = 8;
+    size_t i = 0;
+    __m512i accumulated = _mm512_setzero_si512();
+    __mmask8 carried = 0;
+
+    for (; i + width <= n; i += width) {
+        __m512i current = load_widened_avx512(x + i);
+        __m512i next = _mm512_add_epi64(accumulated, current);
+        carried |= _mm512_cmplt_epu64_mask(next, accumulated);
+        accumulated = next;
+    }
+
+    uint64_t lanes[width];
+    _mm512_storeu_si512(lanes, accumulated);
+    bool okay = (carried == 0);
+    okay &= checked_reduce<width>(lanes, total);
+    okay &= checked_sum_scalar(x + i, n - i, total);
+    return okay;
+}
+#endif
+
+#if defined(TAKANE_SIMD_NEON)
+// Load 2 values from 'x', zero-extended to 64 bits.
+template<typename Type_>
+uint64x2_t load_widened_neon(const Type_* x) {
+    if constexpr(sizeof(Type_) == 8) {
+        return vld1q_u64(reinterpret_cast<const uint64_t*>(x));
+    } else if constexpr(sizeof(Type_) == 4) {
+        return vmovl_u32(vld1_u32(reinterpret_cast<const uint32_t*>(x)));
+    } else {
+        uint64_t values[2] = { x[0], x[1] };
+        return vld1q_u64(values);
+    }
+}
+
+template<typename Type_>
+bool checked_sum_neon(const Type_* x, size_t n, uint64_t& total) {
+    constexpr size_t width = 2;
+    size_t i = 0;
+    uint64x2_t accumulated = vdupq_n_u64(0), carried = vdupq_n_u64(0);
+
+    for (; i + width <= n; i += width) {
+        uint64x2_t current = load_widened_neon(x + i);
+        uint64x2_t next = vaddq_u64(accumulated, current);
+        carried = vorrq_u64(carried, vcltq_u64(next, accumulated));
+        accumulated = next;
+    }
+
+    uint64_t lanes[width];
+    vst1q_u64(lanes, accumulated);
+    bool okay = (vgetq_lane_u64(carried, 0) | vgetq_lane_u64(carried, 1)) == 0;
+    okay &= checked_reduce<width>(lanes, total);
+    okay &= checked_sum_scalar(x + i, n - i, total);
+    return okay;
+}
+#endif
+
+template<typename Type_>
+bool checked_sum(const Type_* x, size_t n, uint64_t& total, Instructions instructions = available_instructions()) {
+    static_assert(std::is_unsigned<Type_>::value);
+
+    switch (instructions) {
+#if defined(TAKANE_SIMD_X86)
+        case Instructions::AVX512:
+            return checked_sum_avx512(x, n, total);
+        case Instructions::AVX2:
+            return checked_sum_avx2(x, n, total);
+#endif
+#if defined(TAKANE_SIMD_NEON)
+        case Instructions::NEON:
+            return checked_sum_neon(x, n, total);
+#endif
+        default:
+            break;
+    }
+
+    return checked_sum_scalar(x, n, total);
+}
+
+}
+
+}
+
+#endif
@@ -7,10 +7,15 @@
 #include <vector>
 #include <stdexcept>
 #include <optional>
+#include <string_view>
 
 #include "ritsuko/ritsuko.hpp"
 #include "ritsuko/hdf5/hdf5.hpp"
 
+#include "utils_hdf5.hpp"
+#include "utils_date.hpp"
+#include "utils_hash.hpp"
+
 namespace takane {
 
 namespace internal_string {
@@ -32,40 +37,39 @@ std::string fetch_format_attribute(const H5Object_& handle) {
     return ritsuko::hdf5::load_scalar_string_attribute(attr);
 }
 
-inline void validate_string_format(const H5::DataSet& handle, hsize_t len, const std::string& format, const std::optional<std::string>& missing_value, hsize_t buffer_size) {
+inline void validate_string_format(const H5::DataSet& handle, hsize_t len, const std::string& format, const std::optional<std::string>& missing_value, hsize_t buffer_size, bool check_utf8 = false) {
     if (format == "date") {
-        ritsuko::hdf5::Stream1dStringDataset stream(&handle, len, buffer_size);
-        for (hsize_t i = 0; i < len; ++i, stream.next()) {
-            auto x = stream.steal();
+        // Formatted columns are usually very repetitive, so we cache the recent valid values.
+        internal_hash::RecentStrings recent;
+        internal_hdf5::iterate_1d_strings(handle, len, buffer_size, [&](hsize_t, std::string_view x) -> void {
             if (missing_value.has_value() && x == *missing_value) {
-                continue;
+                return;
             }
-            if (!ritsuko::is_date(x.c_str(), x.size())) {
-                throw std::runtime_error("expected a date-formatted string (got '" + x + "')");
+            if (!recent.check(x, [](std::string_view y) -> bool { return internal_date::is_date(y.data(), y.size()); })) {
+                throw std::runtime_error("expected a date-formatted string (got '" + std::string(x) + "')");
             }
-        }
+        }, check_utf8);
 
     } else if (format == "date-time") {
-        ritsuko::hdf5::Stream1dStringDataset stream(&handle, len, buffer_size);
-        for (hsize_t i = 0; i < len; ++i, stream.next()) {
-            auto x = stream.steal();
+        internal_hash::RecentStrings recent;
+        internal_hdf5::iterate_1d_strings(handle, len, buffer_size, [&](hsize_t, std::string_view x) -> void {
             if (missing_value.has_value() && x == *missing_value) {
-                continue;
+                return;
             }
-            if (!ritsuko::is_rfc3339(x.c_str(), x.size())) {
-                throw std::runtime_error("expected a date/time-formatted string (got '" + x + "')");
+            if (!recent.check(x, [](std::string_view y) -> bool { return internal_date::is_rfc3339(y.data(), y.size()); })) {
+                throw std::runtime_error("expected a date/time-formatted string (got '" + std::string(x) + "')");
             }
-        }
+        }, check_utf8);
 
     } else if (format == "none") {
-        ritsuko::hdf5::validate_1d_string_dataset(handle, len, buffer_size);
+        internal_hdf5::validate_1d_strings(handle, len, buffer_size, check_utf8);
 
     } else {
         throw std::runtime_error("unsupported format '" + format + "'");
     }
 }
 
-inline void validate_names(const H5::Group& handle, const std::string& name, size_t len, hsize_t buffer_size) {
+inline void validate_names(const H5::Group& handle, const std::string& name, size_t len, hsize_t buffer_size, bool check_utf8 = false) {
     if (!handle.exists(name)) {
         return;
     }
@@ -80,7 +84,7 @@ inline void validate_names(const H5::Group& handle, const std::string& name, siz
         throw std::runtime_error("'" + name + "' should have the same length as the parent object (got " + std::to_string(nlen) + ", expected " + std::to_string(len) + ")");
     }
 
-    ritsuko::hdf5::validate_1d_string_dataset(nhandle, len, buffer_size);
+    internal_hdf5::validate_1d_strings(nhandle, len, buffer_size, check_utf8);
 }
 
 }
@@ -3,12 +3,17 @@
 
 #include "millijson/millijson.hpp"
 #include "utils_json.hpp"
+#include "utils_hash.hpp"
+#include "utils_public.hpp"
+#include "utils_parallel.hpp"
 
-#include <unordered_set>
 #include <string>
 #include <stdexcept>
 #include <filesystem>
 #include <cmath>
+#include <vector>
+#include <functional>
+#include <exception>
 
 namespace takane {
 
@@ -51,7 +56,7 @@ inline std::pair<size_t, size_t> extract_dimensions_json(const internal_json::Js
     return std::make_pair(num_rows, num_cols);
 }
 
-inline void check_names_json(const std::filesystem::path& dir, std::unordered_set<std::string>& present) try {
+inline void check_names_json(const std::filesystem::path& dir, internal_hash::StringSet& present) try {
     auto parsed = internal_json::parse_file(dir / "names.json");
     if (parsed->type() != millijson::ARRAY) {
         throw std::runtime_error("expected an array");
@@ -68,14 +73,13 @@ inline void check_names_json(const std::filesystem::path& dir, std::unordered_se
         }
 
         auto nptr = reinterpret_cast<const millijson::String*>(eptr.get());
-        auto name = nptr->value();
+        const auto& name = nptr->value();
         if (name.empty()) {
             throw std::runtime_error("name should not be an empty string");
         }
-        if (present.find(name) != present.end()) {
+        if (!present.insert(name)) {
             throw std::runtime_error("detected duplicated name '" + name + "'");
         }
-        present.insert(std::move(name));
     }
 
 } catch (std::exception& e) {
@@ -83,11 +87,62 @@ inline void check_names_json(const std::filesystem::path& dir, std::unordered_se
 }
 
 inline size_t check_names_json(const std::filesystem::path& dir) {
-    std::unordered_set<std::string> present;
+    internal_hash::StringSet present;
     check_names_json(dir, present);
     return present.size();
 }
 
+// Independent components of a summarized experiment (and its derived types)
+// that can be validated concurrently, e.g., each assay, the row and column
+// data, the row ranges, reduced dimensions and so on. Each task validates a
+// single component and checks its dimensions against those of the parent.
+//
+// Tasks are added in the same order as they would be validated serially, and
+// run() rethrows the error from the earliest failing task. Cheap checks that
+// are needed to define further tasks (e.g., version strings, 'names.json')
+// are executed immediately by plan(); if one fails, its error is stored as
+// the last task and no more tasks are added. This ensures that we report the
+// same error as a serial validation of all components.
+class ComponentTasks {
+public:
+    template<class Function_>
+    void add(Function_ fun) {
+        if (!my_failed) {
+            my_tasks.emplace_back(std::move(fun));
+        }
+    }
+
+    template<class Function_>
+    void plan(Function_ fun) {
+        if (my_failed) {
+            return;
+        }
+        try {
+            fun();
+        } catch (...) {
+            auto error = std::current_exception();
+            my_tasks.emplace_back([error](Options&) -> void { std::rethrow_exception(error); });
+            my_failed = true;
+        }
+    }
+
+    // Whether a planning step has failed, in which case there is no point
+    // defining any more tasks.
+    bool failed() const {
+        return my_failed;
+    }
+
+    void run(Options& options) {
+        internal_parallel::parallelize_objects(my_tasks.size(), options, [&](size_t t, Options& task_options) -> void {
+            my_tasks[t](task_options);
+        });
+    }
+
+private:
+    std::vector<std::function<void(Options&)> > my_tasks;
+    bool my_failed = false;
+};
+
 }
 
 }
@@ -0,0 +1,81 @@
+#ifndef TAKANE_UTILS_UTF8_HPP
+#define TAKANE_UTILS_UTF8_HPP
+
+#include <cstddef>
+#include <string_view>
+
+#include "utils_simd.hpp"
+
+namespace takane {
+
+namespace internal_utf8 {
+
+// Length of the multi-byte sequence starting at 'x[0]', where 'x[0]' is not
+// an ASCII character; or zero if the sequence is not valid UTF-8. This
+// follows the well-formed byte sequences in Table 3-7 of the Unicode
+// standard, so overlong encodings, surrogates and code points above U+10FFFF
+// are all rejected.
+inline size_t validate_sequence(const unsigned char* x, size_t n) {
+    unsigned char lead = x[0];
+    size_t len;
+    unsigned char lower = 0x80, upper = 0xBF; // bounds for the second byte.
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        len = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        len = 3;
+        if (lead == 0xE0) {
+            lower = 0xA0;
+        } else if (lead == 0xED) {
+            upper = 0x9F;
+        }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        len = 4;
+        if (lead == 0xF0) {
+            lower = 0x90;
+        } else if (lead == 0xF4) {
+            upper = 0x8F;
+        }
+    } else {
+        return 0;
+    }
+
+    if (len > n || x[1] < lower || x[1] > upper) {
+        return 0;
+    }
+    for (size_t i = 2; i < len; ++i) {
+        if ((x[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return len;
+}
+
+// Check whether a string is valid UTF-8. Runs of ASCII characters are skipped
+// with the vectorized kernel, so we only need to inspect each byte for the
+// (usually rare) multi-byte sequences.
+inline bool is_valid(const char* x, size_t n, internal_simd::Instructions instructions = internal_simd::available_instructions()) {
+    auto ptr = reinterpret_cast<const unsigned char*>(x);
+    size_t i = 0;
+    while (true) {
+        i += internal_simd::find_non_ascii(x + i, n - i, instructions);
+        if (i == n) {
+            return true;
+        }
+        size_t len = validate_sequence(ptr + i, n - i);
+        if (len == 0) {
+            return false;
+        }
+        i += len;
+    }
+}
+
+inline bool is_valid(std::string_view x, internal_simd::Instructions instructions = internal_simd::available_instructions()) {
+    return is_valid(x.data(), x.size(), instructions);
+}
+
+}
+
+}
+
+#endif
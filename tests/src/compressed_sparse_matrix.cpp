@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include <random>
+#include <algorithm>
 
 struct SparseMatrixTest : public ::testing::Test {
     SparseMatrixTest() {
@@ -33,6 +34,17 @@ public:
             }
         });
     }
+
+    void expect_error(const std::string& msg, takane::Options& opts) {
+        EXPECT_ANY_THROW({
+            try {
+                test_validate(path, opts);
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+                throw;
+            }
+        });
+    }
 };
 
 TEST_F(SparseMatrixTest, Basic) {
@@ -274,6 +286,130 @@ TEST_F(SparseMatrixTest, IndicesFails) {
     expect_error("strictly increasing");
 }
 
+TEST_F(SparseMatrixTest, Parallel) {
+    compressed_sparse_matrix::mock(path, 200, 150, 0.1);
+
+    takane::Options opts;
+    opts.num_threads = 3;
+    opts.hdf5_buffer_size = 13;
+    test_validate(path, opts);
+    opts.hdf5_memory_map = false;
+    test_validate(path, opts);
+
+    std::vector<int> expected;
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto dhandle = ghandle.openDataSet("indices");
+        expected.resize(ritsuko::hdf5::get_1d_length(dhandle, false));
+        dhandle.read(expected.data(), H5::PredType::NATIVE_INT);
+    }
+
+    auto expect_parallel_error = [&](const std::string& msg) -> void {
+        for (int mapped = 0; mapped < 2; ++mapped) {
+            opts.hdf5_memory_map = mapped;
+            EXPECT_ANY_THROW({
+                try {
+                    test_validate(path, opts);
+                } catch (std::exception& e) {
+                    EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+                    throw;
+                }
+            });
+        }
+    };
+
+    // Reporting the first error, even if later ranges have different errors.
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto dhandle = ghandle.openDataSet("indices");
+        auto copy = expected;
+        std::reverse(copy.begin() + copy.size() / 2, copy.end());
+        copy[copy.size() / 4] = 200;
+        dhandle.write(copy.data(), H5::PredType::NATIVE_INT);
+    }
+    expect_parallel_error("out-of-range");
+
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto dhandle = ghandle.openDataSet("indices");
+        auto copy = expected;
+        std::reverse(copy.begin(), copy.begin() + copy.size() / 4);
+        copy[copy.size() - 1] = 200;
+        dhandle.write(copy.data(), H5::PredType::NATIVE_INT);
+    }
+    expect_parallel_error("strictly increasing");
+}
+
+TEST_F(SparseMatrixTest, Streaming) {
+    takane::Options opts;
+    opts.compressed_sparse_matrix_indptr_memory_limit = 0;
+    opts.hdf5_buffer_size = 7;
+
+    compressed_sparse_matrix::mock(path, 50, 40, 0.2);
+    test_validate(path, opts);
+    opts.hdf5_memory_map = false;
+    test_validate(path, opts);
+
+    std::vector<int> indptrs, indices;
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto phandle = ghandle.openDataSet("indptr");
+        indptrs.resize(41);
+        phandle.read(indptrs.data(), H5::PredType::NATIVE_INT);
+        auto ihandle = ghandle.openDataSet("indices");
+        indices.resize(ritsuko::hdf5::get_1d_length(ihandle, false));
+        ihandle.read(indices.data(), H5::PredType::NATIVE_INT);
+    }
+
+    // Checking that the pointer errors are reported in the same order.
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto phandle = ghandle.openDataSet("indptr");
+        auto copy = indptrs;
+        std::swap(copy[10], copy[20]);
+        copy.back() += 1;
+        phandle.write(copy.data(), H5::PredType::NATIVE_INT);
+    }
+    expect_error("last entry", opts);
+
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto phandle = ghandle.openDataSet("indptr");
+        auto copy = indptrs;
+        std::swap(copy[10], copy[20]);
+        phandle.write(copy.data(), H5::PredType::NATIVE_INT);
+    }
+    expect_error("should be sorted", opts);
+
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto phandle = ghandle.openDataSet("indptr");
+        phandle.write(indptrs.data(), H5::PredType::NATIVE_INT);
+        auto ihandle = ghandle.openDataSet("indices");
+        auto copy = indices;
+        copy[copy.size() / 2] = 50;
+        ihandle.write(copy.data(), H5::PredType::NATIVE_INT);
+    }
+    expect_error("out-of-range", opts);
+
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto ihandle = ghandle.openDataSet("indices");
+        auto copy = indices;
+        std::reverse(copy.begin(), copy.end());
+        ihandle.write(copy.data(), H5::PredType::NATIVE_INT);
+    }
+    expect_error("strictly increasing", opts);
+}
+
 TEST_F(SparseMatrixTest, Names) {
     {
         compressed_sparse_matrix::mock(path, 55, 33, 0.25);
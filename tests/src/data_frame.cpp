@@ -11,6 +11,8 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <mutex>
+#include <algorithm>
 
 struct Hdf5DataFrameTest : public ::testing::Test {
     Hdf5DataFrameTest() {
@@ -224,6 +226,98 @@ TEST_F(Hdf5DataFrameTest, Other) {
     expect_error("more objects than expected");
 }
 
+TEST_F(Hdf5DataFrameTest, Parallel) {
+    std::vector<data_frame::ColumnDetails> columns(40);
+    for (size_t c = 0; c < columns.size(); ++c) {
+        columns[c].name = "col" + std::to_string(c);
+        if (c % 4 == 1) {
+            columns[c].type = data_frame::ColumnType::NUMBER;
+        } else if (c % 4 == 2) {
+            columns[c].type = data_frame::ColumnType::STRING;
+        } else if (c % 4 == 3) {
+            columns[c].type = data_frame::ColumnType::OTHER;
+        }
+    }
+
+    for (int nthreads : object_thread_counts()) {
+        takane::Options opts;
+        opts.num_threads = nthreads;
+        opts.parallel_objects = true;
+
+        data_frame::mock(dir, 21, columns);
+        std::filesystem::create_directory(dir / "other_columns");
+        for (size_t c = 3; c < columns.size(); c += 4) {
+            data_frame::mock(dir / "other_columns" / std::to_string(c), 21, {});
+        }
+        test_validate(dir, opts);
+
+        // The first failing column is always reported.
+        {
+            auto handle = reopen();
+            auto ghandle = handle.openGroup("data_frame/data");
+            ghandle.unlink("37");
+            ghandle.unlink("30");
+        }
+        expect_validation_error(dir, "other_columns/30", opts);
+    }
+}
+
+TEST_F(Hdf5DataFrameTest, ParallelOtherColumns) {
+    // The 'other' columns only call the custom functions below, so the
+    // parallel path can be tested without a thread-safe HDF5 library.
+    AssumeThreadsafeHdf5 force;
+
+    size_t NC = 20;
+    std::vector<data_frame::ColumnDetails> columns(NC);
+    for (size_t c = 0; c < NC; ++c) {
+        columns[c].name = "col" + std::to_string(c);
+        columns[c].type = data_frame::ColumnType::OTHER;
+    }
+    data_frame::mock(dir, 21, columns);
+    std::filesystem::create_directory(dir / "other_columns");
+    for (size_t c = 0; c < NC; ++c) {
+        initialize_directory_simple(dir / "other_columns" / std::to_string(c), "mock_column", "1.0");
+    }
+
+    std::mutex lock;
+    std::vector<size_t> validated;
+    std::vector<int> column_threads;
+    std::vector<size_t> failing;
+
+    takane::Options opts;
+    opts.parallel_objects = true;
+    opts.custom_validate["mock_column"] = [&](const std::filesystem::path& p, const takane::ObjectMetadata&, takane::Options& column_options) -> void {
+        size_t c = std::stoul(p.filename().string());
+        std::lock_guard<std::mutex> lck(lock);
+        validated.push_back(c);
+        column_threads.push_back(column_options.num_threads);
+        if (std::find(failing.begin(), failing.end(), c) != failing.end()) {
+            throw std::runtime_error("mock failure");
+        }
+    };
+    opts.custom_height["mock_column"] = [](const std::filesystem::path&, const takane::ObjectMetadata&, takane::Options&) -> size_t { return 21; };
+
+    for (int nthreads : object_thread_counts()) {
+        opts.num_threads = nthreads;
+        validated.clear();
+        column_threads.clear();
+        failing.clear();
+        test_validate(dir, opts);
+
+        std::sort(validated.begin(), validated.end());
+        std::vector<size_t> expected(NC);
+        std::iota(expected.begin(), expected.end(), 0);
+        EXPECT_EQ(validated, expected);
+
+        // Each column gets its share of the threads if validated in parallel.
+        EXPECT_EQ(column_threads, std::vector<int>(NC, 1));
+
+        // The first failing column is always reported.
+        failing = { 17, 5, 13 };
+        expect_validation_error(dir, "'other' column 5;", opts);
+    }
+}
+
 TEST_F(Hdf5DataFrameTest, Integer) {
     std::vector<data_frame::ColumnDetails> columns(1);
     columns[0].name = "Aaron";
@@ -6,9 +6,12 @@
 #include "utils.h"
 
 #include <string>
+#include <mutex>
 #include <vector>
 #include <filesystem>
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
 
 struct DelayedArrayTest : public ::testing::Test {
     DelayedArrayTest() {
@@ -189,3 +192,174 @@ TEST_F(DelayedArrayTest, DimensionalityChecks) {
     }
     expect_error("dimension extents");
 }
+
+static void mock_combined(const std::filesystem::path& dir, const std::vector<int>& indices, size_t num_seeds) {
+    initialize_directory_simple(dir, "delayed_array", "1.0");
+    H5::H5File handle(dir / "array.h5", H5F_ACC_TRUNC);
+    auto ghandle = handle.createGroup("delayed_array");
+    hdf5_utils::attach_attribute(ghandle, "delayed_type", "operation");
+    hdf5_utils::attach_attribute(ghandle, "delayed_operation", "combine");
+    hdf5_utils::attach_attribute(ghandle, "delayed_version", "1.1");
+
+    auto ahandle = ghandle.createDataSet("along", H5::PredType::NATIVE_UINT32, H5S_SCALAR);
+    int along = 1;
+    ahandle.write(&along, H5::PredType::NATIVE_INT);
+
+    auto shandle = ghandle.createGroup("seeds");
+    int len = indices.size();
+    auto attr = shandle.createAttribute("length", H5::PredType::NATIVE_UINT32, H5S_SCALAR);
+    attr.write(H5::PredType::NATIVE_INT, &len);
+
+    for (int i = 0; i < len; ++i) {
+        auto xhandle = shandle.createGroup(std::to_string(i));
+        hdf5_utils::attach_attribute(xhandle, "delayed_type", "array");
+        hdf5_utils::attach_attribute(xhandle, "delayed_array", "custom takane seed array");
+
+        H5::StrType stype(0, H5T_VARIABLE);
+        auto thandle = xhandle.createDataSet("type", stype, H5S_SCALAR);
+        thandle.write(std::string("INTEGER"), stype);
+
+        std::vector<hsize_t> dims { 10, 20 };
+        auto dhandle = hdf5_utils::spawn_data(xhandle, "dimensions", dims.size(), H5::PredType::NATIVE_UINT32);
+        dhandle.write(dims.data(), H5::PredType::NATIVE_HSIZE);
+
+        auto ihandle = xhandle.createDataSet("index", H5::PredType::NATIVE_UINT32, H5S_SCALAR);
+        ihandle.write(&(indices[i]), H5::PredType::NATIVE_INT);
+    }
+
+    auto seed_path = dir / "seeds";
+    std::filesystem::create_directory(seed_path);
+    for (size_t s = 0; s < num_seeds; ++s) {
+        dense_array::mock(seed_path / std::to_string(s), dense_array::Type::INTEGER, { 10, 20 });
+    }
+}
+
+TEST_F(DelayedArrayTest, RepeatedSeeds) {
+    for (int nthreads : object_thread_counts()) {
+        takane::Options opts;
+        opts.num_threads = nthreads;
+        opts.parallel_objects = true;
+
+        mock_combined(dir, { 0, 1, 0, 2, 1, 0 }, 3);
+        std::mutex lock;
+        std::vector<std::string> validated;
+        opts.custom_global_validate = [&](const std::filesystem::path& p, const takane::ObjectMetadata&, takane::Options&) -> void {
+            if (p.parent_path().filename() == "seeds") {
+                std::lock_guard<std::mutex> lck(lock);
+                validated.push_back(p.filename().string());
+            }
+        };
+        test_validate(dir, opts);
+
+        // Each seed is only validated once.
+        std::sort(validated.begin(), validated.end());
+        std::vector<std::string> expected { "0", "1", "2" };
+        EXPECT_EQ(validated, expected);
+
+        auto& areg = opts.delayed_array_options.array_validate_registry;
+        EXPECT_TRUE(areg.find("custom takane seed array") == areg.end());
+        EXPECT_FALSE(opts.delayed_array_options.details_only);
+
+        // The first failing reference is always reported, even if it is a later seed that fails.
+        takane::Options eopts;
+        eopts.num_threads = nthreads;
+        eopts.parallel_objects = true;
+        dense_array::mock(dir / "seeds" / "2", dense_array::Type::INTEGER, { 10, 5 });
+        dense_array::mock(dir / "seeds" / "1", dense_array::Type::INTEGER, { 10, 20, 5 });
+        expect_error("dimensionality of 'seeds/1'", eopts);
+
+        initialize_directory_simple(dir / "seeds" / "1", "dense_array", "2.0");
+        expect_error("unsupported version '2.0'", eopts);
+    }
+}
+
+TEST_F(DelayedArrayTest, ParallelCustomSeeds) {
+    // The seeds only call the custom functions below, so the parallel
+    // pre-pass can be tested without a thread-safe HDF5 library.
+    AssumeThreadsafeHdf5 force;
+
+    size_t num_seeds = 6;
+    mock_combined(dir, { 0, 1, 0, 2, 1, 0, 5, 4, 3 }, num_seeds);
+    for (size_t s = 0; s < num_seeds; ++s) {
+        initialize_directory_simple(dir / "seeds" / std::to_string(s), "mock_seed", "1.0");
+    }
+
+    std::mutex lock;
+    std::vector<std::string> validated;
+    std::vector<std::string> failing;
+
+    takane::Options opts;
+    opts.parallel_objects = true;
+    opts.custom_validate["mock_seed"] = [&](const std::filesystem::path& p, const takane::ObjectMetadata&, takane::Options&) -> void {
+        auto name = p.filename().string();
+        std::lock_guard<std::mutex> lck(lock);
+        validated.push_back(name);
+        if (std::find(failing.begin(), failing.end(), name) != failing.end()) {
+            throw std::runtime_error("mock failure");
+        }
+    };
+    opts.custom_dimensions["mock_seed"] = [](const std::filesystem::path&, const takane::ObjectMetadata&, takane::Options&) -> std::vector<size_t> {
+        return std::vector<size_t>{ 10, 20 };
+    };
+
+    for (int nthreads : object_thread_counts()) {
+        opts.num_threads = nthreads;
+        validated.clear();
+        failing.clear();
+        test_validate(dir, opts);
+
+        // Each seed is only validated once.
+        std::sort(validated.begin(), validated.end());
+        std::vector<std::string> expected { "0", "1", "2", "3", "4", "5" };
+        EXPECT_EQ(validated, expected);
+
+        // The first failing reference is always reported, even if a later seed has a lower index.
+        failing = { "1", "3" };
+        expect_validation_error(dir, "seeds/1", opts);
+        failing = { "4", "3" };
+        expect_validation_error(dir, "seeds/4", opts);
+    }
+}
+
+TEST_F(DelayedArrayTest, CachedDimensions) {
+    delayed_array::mock(dir, dense_array::Type::INTEGER, { 10, 20 });
+
+    takane::Options opts;
+    test_validate(dir, opts);
+    EXPECT_FALSE(opts.session_cache); // only retained if supplied by the caller.
+
+    opts.session_cache = std::make_shared<takane::internal_cache::SessionCache>();
+    test_validate(dir, opts);
+    auto num_cached = opts.session_cache->size();
+    EXPECT_GT(num_cached, 0u);
+
+    std::vector<size_t> expected { 10, 20 };
+    EXPECT_EQ(test_dimensions(dir, opts), expected);
+    EXPECT_EQ(test_height(dir, opts), 10u);
+    EXPECT_EQ(opts.session_cache->size(), num_cached); // re-using the entry from validation.
+
+    // Changes to the file are picked up.
+    delayed_array::mock(dir, dense_array::Type::INTEGER, { 10, 20, 30 });
+    std::filesystem::last_write_time(dir / "array.h5", std::filesystem::last_write_time(dir / "array.h5") + std::chrono::seconds(1));
+    expected.push_back(30);
+    EXPECT_EQ(test_dimensions(dir, opts), expected);
+
+    // No caching if requested.
+    takane::Options uncached;
+    uncached.cache_results = false;
+    EXPECT_EQ(test_dimensions(dir, uncached), expected);
+    EXPECT_FALSE(uncached.session_cache);
+
+    uncached.session_cache = std::make_shared<takane::internal_cache::SessionCache>();
+    test_validate(dir, uncached);
+    EXPECT_EQ(test_dimensions(dir, uncached), expected);
+    EXPECT_EQ(uncached.session_cache->size(), 0u);
+
+    // Same for a custom global validation function, which might have side effects.
+    takane::Options global;
+    global.session_cache = std::make_shared<takane::internal_cache::SessionCache>();
+    global.custom_global_validate = [](const std::filesystem::path&, const takane::ObjectMetadata&, takane::Options&) -> void {};
+    test_validate(dir, global);
+    EXPECT_EQ(test_dimensions(dir, global), expected);
+    EXPECT_EQ(global.session_cache->size(), 0u);
+}
@@ -376,6 +376,95 @@ TEST_F(GenomicRangesTest, Strand) {
     expect_error("same length");
 }
 
+TEST_F(GenomicRangesTest, Parallel) {
+    std::vector<int> seq_id, start, width, strand;
+    for (int i = 0; i < 1000; ++i) {
+        seq_id.push_back(i % 7);
+        start.push_back(i * 10 + 1); 
+        width.push_back((i % 2) * 10 + 1); 
+        strand.push_back((i % 3) - 1);
+    }
+    std::vector<int> seq_length(7, 100000), is_circular(7);
+    is_circular[0] = 1;
+
+    genomic_ranges::mock(dir, seq_id, start, width, strand, seq_length, is_circular);
+    takane::Options opts;
+    opts.num_threads = 3;
+    opts.hdf5_buffer_size = 13;
+    test_validate(dir, opts);
+    opts.hdf5_memory_map = false;
+    test_validate(dir, opts);
+
+    // Errors in the other columns take precedence over earlier errors in the strand.
+    strand[3] = 2;
+    start[995] = 0;
+    genomic_ranges::mock(dir, seq_id, start, width, strand, seq_length, is_circular);
+    expect_error("non-positive", opts);
+    opts.hdf5_memory_map = true;
+    expect_error("non-positive", opts);
+
+    start[995] = 1;
+    genomic_ranges::mock(dir, seq_id, start, width, strand, seq_length, is_circular);
+    expect_error("0, -1, or 1 (got 2)", opts);
+}
+
+TEST_F(GenomicRangesTest, CachedSequenceInformation) {
+    genomic_ranges::mock(dir, 
+        { 0, 1, 0, 2 },
+        { 90, 100, 50, 100 },
+        { 11, 101, 51, 201 },
+        { 1, -1, 0, -1 },
+        { 100, 200, 300 },
+        { 0, 0, 0 }
+    );
+
+    // By default, the cache only lives for the duration of the call.
+    takane::Options opts;
+    test_validate(dir, opts);
+    EXPECT_FALSE(opts.session_cache);
+
+    // Otherwise, a cache supplied by the caller persists across calls.
+    opts.session_cache = std::make_shared<takane::internal_cache::SessionCache>();
+    test_validate(dir, opts);
+    EXPECT_EQ(opts.session_cache->size(), 1u);
+    test_validate(dir, opts);
+    EXPECT_EQ(opts.session_cache->size(), 1u);
+
+    // Same sequence information in a different directory re-uses the cached entry.
+    std::filesystem::path other = "TEST_genomic_ranges_other";
+    std::filesystem::remove_all(other);
+    std::filesystem::copy(dir, other, std::filesystem::copy_options::recursive);
+    test_validate(other, opts);
+    EXPECT_EQ(opts.session_cache->size(), 1u);
+
+    // Modifying the sequence information means that the cache is not used.
+    sequence_information::mock(dir / "sequence_information", { "0", "1", "2" }, { 100, 150, 300 }, { 0, 0, 0 }, { "mm10", "mm10", "mm10" });
+    expect_error("end position beyond sequence length", opts);
+    EXPECT_EQ(opts.session_cache->size(), 2u);
+
+    // Options that affect validation are part of the key.
+    opts.validate_utf8 = true;
+    test_validate(other, opts);
+    EXPECT_EQ(opts.session_cache->size(), 3u);
+
+    // No caching if we have a custom function.
+    takane::Options opts2;
+    opts2.session_cache = std::make_shared<takane::internal_cache::SessionCache>();
+    opts2.custom_global_validate = [](const std::filesystem::path&, const takane::ObjectMetadata&, takane::Options&) -> void {};
+    test_validate(other, opts2);
+    EXPECT_EQ(opts2.session_cache->size(), 0u);
+
+    takane::Options opts3;
+    opts3.cache_results = false;
+    test_validate(other, opts3);
+    EXPECT_FALSE(opts3.session_cache);
+
+    // Even if the caller supplies a cache.
+    opts3.session_cache = std::make_shared<takane::internal_cache::SessionCache>();
+    test_validate(other, opts3);
+    EXPECT_EQ(opts3.session_cache->size(), 0u);
+}
+
 TEST_F(GenomicRangesTest, Names) {
     genomic_ranges::mock(dir, 6, 4); 
 
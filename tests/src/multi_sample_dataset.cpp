@@ -9,6 +9,9 @@
 #include <vector>
 #include <filesystem>
 #include <stdexcept>
+#include <mutex>
+#include <algorithm>
+#include <numeric>
 
 struct MultiSampleDatasetTest : public ::testing::Test {
     MultiSampleDatasetTest() {
@@ -145,6 +148,98 @@ TEST_F(MultiSampleDatasetTest, Experiments) {
     expect_error("should equal the number of columns");
 }
 
+TEST_F(MultiSampleDatasetTest, Parallel) {
+    multi_sample_dataset::Options opt(5);
+    for (size_t e = 0; e < 6; ++e) {
+        opt.experiments.emplace_back(10 + e, 3 + e);
+    }
+
+    for (int nthreads : object_thread_counts()) {
+        takane::Options opts;
+        opts.num_threads = nthreads;
+        opts.parallel_objects = true;
+
+        multi_sample_dataset::mock(dir, opt);
+        test_validate(dir, opts);
+
+        // Sample map errors are only reported after all experiments are validated.
+        {
+            H5::H5File handle(dir / "sample_map.h5", H5F_ACC_RDWR);
+            auto ghandle = handle.openGroup("multi_sample_dataset");
+            ghandle.unlink("1");
+            hdf5_utils::spawn_data(ghandle, "1", 2, H5::PredType::NATIVE_UINT32);
+        }
+        initialize_directory_simple(dir / "experiments" / "4", "summarized_experiment", "2.0");
+        expect_validation_error(dir, "failed to validate 'experiments/4'", opts);
+
+        // The first failing experiment is always reported.
+        initialize_directory_simple(dir / "experiments" / "2", "summarized_experiment", "2.0");
+        expect_validation_error(dir, "failed to validate 'experiments/2'", opts);
+
+        // Same for the sample map.
+        multi_sample_dataset::mock(dir, opt);
+        {
+            H5::H5File handle(dir / "sample_map.h5", H5F_ACC_RDWR);
+            auto ghandle = handle.openGroup("multi_sample_dataset");
+            ghandle.unlink("3");
+            hdf5_utils::spawn_data(ghandle, "3", 2, H5::PredType::NATIVE_UINT32);
+            ghandle.unlink("5");
+            hdf5_utils::spawn_data(ghandle, "5", 8, H5::PredType::NATIVE_INT32);
+        }
+        expect_validation_error(dir, "'multi_sample_dataset/3' should equal", opts);
+    }
+}
+
+TEST_F(MultiSampleDatasetTest, ParallelCustomExperiments) {
+    // Without a sample map, the parallel jobs only call the custom functions
+    // below, so they can be tested without a thread-safe HDF5 library.
+    AssumeThreadsafeHdf5 force;
+
+    multi_sample_dataset::Options opt(5);
+    size_t num_experiments = 8;
+    for (size_t e = 0; e < num_experiments; ++e) {
+        opt.experiments.emplace_back(10, 3);
+    }
+    multi_sample_dataset::mock(dir, opt);
+    std::filesystem::remove(dir / "sample_map.h5");
+    for (size_t e = 0; e < num_experiments; ++e) {
+        initialize_directory_simple(dir / "experiments" / std::to_string(e), "mock_experiment", "1.0");
+    }
+
+    std::mutex lock;
+    std::vector<size_t> validated;
+    std::vector<size_t> failing;
+
+    takane::Options opts;
+    opts.parallel_objects = true;
+    opts.custom_satisfies_interface["SUMMARIZED_EXPERIMENT"].insert("mock_experiment");
+    opts.custom_validate["mock_experiment"] = [&](const std::filesystem::path& p, const takane::ObjectMetadata&, takane::Options&) -> void {
+        size_t e = std::stoul(p.filename().string());
+        std::lock_guard<std::mutex> lck(lock);
+        validated.push_back(e);
+        if (std::find(failing.begin(), failing.end(), e) != failing.end()) {
+            throw std::runtime_error("mock failure");
+        }
+    };
+
+    for (int nthreads : object_thread_counts()) {
+        opts.num_threads = nthreads;
+
+        // The missing sample map is only reported after all experiments are validated.
+        validated.clear();
+        failing.clear();
+        expect_validation_error(dir, "failed to validate the sample mapping", opts);
+        std::sort(validated.begin(), validated.end());
+        std::vector<size_t> expected(num_experiments);
+        std::iota(expected.begin(), expected.end(), 0);
+        EXPECT_EQ(validated, expected);
+
+        // The first failing experiment is always reported.
+        failing = { 6, 2, 4 };
+        expect_validation_error(dir, "failed to validate 'experiments/2'", opts);
+    }
+}
+
 TEST_F(MultiSampleDatasetTest, OtherData) {
     multi_sample_dataset::Options opt(4);
     multi_sample_dataset::mock(dir, opt);
@@ -10,6 +10,7 @@
 #include <vector>
 #include <filesystem>
 #include <stdexcept>
+#include <fstream>
 
 struct SpatialExperimentTest : public ::testing::Test {
     SpatialExperimentTest() {
@@ -321,6 +322,44 @@ TEST_F(SpatialExperimentTest, ImageFormats) {
     expect_error("not currently supported");
 }
 
+TEST_F(SpatialExperimentTest, ParallelImages) {
+    spatial_experiment::Options options(20, 19);
+    options.num_samples = 3;
+    options.num_images_per_sample = 10;
+    spatial_experiment::mock(dir, options);
+
+    takane::Options vopt;
+    vopt.num_threads = 4;
+    test_validate(dir, vopt);
+
+    // Earliest invalid image is reported.
+    for (auto i : { 9, 4 }) {
+        auto ipath = dir / "images" / std::to_string(i);
+        ipath += (i % 3 == 0 ? ".png" : ".tif");
+        std::ofstream handle(ipath);
+        handle << "foobar";
+    }
+    EXPECT_ANY_THROW({
+        try {
+            test_validate(dir, vopt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("incorrect TIFF file signature"));
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("4.tif"));
+            throw;
+        }
+    });
+
+    std::filesystem::remove(dir / "images" / "4.tif");
+    EXPECT_ANY_THROW({
+        try {
+            test_validate(dir, vopt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("failed to open"));
+            throw;
+        }
+    });
+}
+
 TEST_F(SpatialExperimentTest, OtherImageFormats) {
     spatial_experiment::Options options(20, 19);
     options.num_samples = 2;
@@ -89,6 +89,35 @@ TEST_F(StringFactorTest, Codes) {
     test_validate(dir);
 }
 
+TEST_F(StringFactorTest, LongCodes) {
+    // Enough codes to exercise the vectorized checks, with placeholders that are larger than the number of levels.
+    std::vector<int> codes(1000);
+    for (size_t i = 0; i < codes.size(); ++i) {
+        codes[i] = (i % 7 == 0 ? 255 : i % 5);
+    }
+
+    {
+        auto handle = initialize();
+        auto ghandle = handle.createGroup(name);
+        auto dhandle = hdf5_utils::spawn_data(ghandle, "codes", codes.size(), H5::PredType::NATIVE_UINT8);
+        dhandle.write(codes.data(), H5::PredType::NATIVE_INT);
+        hdf5_utils::spawn_string_data(ghandle, "levels", 3, { "A", "B", "C", "D", "E" });
+        auto ahandle = dhandle.createAttribute("missing-value-placeholder", H5::PredType::NATIVE_UINT8, H5S_SCALAR);
+        int val = 255;
+        ahandle.write(H5::PredType::NATIVE_INT, &val);
+    }
+    test_validate(dir);
+
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        auto dhandle = ghandle.openDataSet("codes");
+        codes[778] = 5;
+        dhandle.write(codes.data(), H5::PredType::NATIVE_INT);
+    }
+    expect_error("number of levels");
+}
+
 TEST_F(StringFactorTest, Ordered) {
     {
         auto handle = initialize();
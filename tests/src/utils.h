@@ -13,6 +13,7 @@
 #include "H5Cpp.h"
 
 #include "takane/utils_public.hpp"
+#include "takane/utils_parallel.hpp"
 
 void test_validate(const std::filesystem::path&);
 void test_validate(const std::filesystem::path&, takane::Options& opts);
@@ -23,6 +24,34 @@ size_t test_height(const std::filesystem::path&, takane::Options& opts);
 std::vector<size_t> test_dimensions(const std::filesystem::path&);
 std::vector<size_t> test_dimensions(const std::filesystem::path&, takane::Options& opts);
 
+// Pretend that the HDF5 library is thread-safe while this object exists, so
+// that the parallel code paths are exercised in the default HDF5 build. This
+// should only be used in tests where the parallel jobs do not call HDF5.
+struct AssumeThreadsafeHdf5 {
+    AssumeThreadsafeHdf5() {
+        takane::internal_parallel::hdf5_threadsafe_override() = true;
+    }
+    ~AssumeThreadsafeHdf5() {
+        takane::internal_parallel::hdf5_threadsafe_override().reset();
+    }
+};
+
+// Thread counts to use when testing the validation of child objects with
+// Options::parallel_objects. The multi-threaded count is only included if
+// the parallel code path can be used, i.e., with a thread-safe HDF5 library
+// or inside an AssumeThreadsafeHdf5 scope; otherwise we only test the serial
+// path, as the validation of built-in child objects calls HDF5.
+inline std::vector<int> object_thread_counts() {
+    takane::Options opts;
+    opts.num_threads = 3;
+    opts.parallel_objects = true;
+    if (takane::internal_parallel::can_parallelize_objects(opts)) {
+        return { 1, 3 };
+    } else {
+        return { 1 };
+    }
+}
+
 inline void initialize_directory(const std::filesystem::path& dir) {
     if (std::filesystem::exists(dir)) {
         std::filesystem::remove_all(dir);
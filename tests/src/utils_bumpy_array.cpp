@@ -10,6 +10,8 @@
 #include <string>
 #include <filesystem>
 #include <fstream>
+#include <random>
+#include <vector>
 
 struct BumpyArrayUtilsTest : public::testing::Test {
     BumpyArrayUtilsTest() {
@@ -105,6 +107,14 @@ TEST_F(BumpyArrayUtilsTest, Lengths) {
         atomic_vector::mock(dir / "concatenated", 7, atomic_vector::Type::INTEGER);
     }
     expect_error("sum of 'lengths'");
+
+    {
+        auto handle = reopen();
+        auto ghandle = handle.openGroup(name);
+        ghandle.unlink("lengths");
+        hdf5_utils::spawn_numeric_data<uint64_t>(ghandle, "lengths", H5::PredType::NATIVE_UINT64, { 4, static_cast<uint64_t>(-1), 2, 1 });
+    }
+    expect_error("does not fit in a 64-bit unsigned integer");
 }
 
 TEST_F(BumpyArrayUtilsTest, Dense) {
@@ -328,3 +338,87 @@ TEST_F(BumpyArrayUtilsTest, Names) {
     }
     expect_error("same length");
 }
+
+TEST_F(BumpyArrayUtilsTest, SparseBlocks) {
+    // Generating strictly increasing coordinates, where the last dimension is the slowest-changing.
+    std::vector<uint64_t> dims { 7, 5, 11 };
+    std::vector<std::vector<int> > coords(dims.size());
+    std::mt19937_64 rng(42);
+    for (uint64_t k = 0; k < dims[2]; ++k) {
+        for (uint64_t j = 0; j < dims[1]; ++j) {
+            for (uint64_t i = 0; i < dims[0]; ++i) {
+                if (rng() % 3 == 0) {
+                    coords[0].push_back(i);
+                    coords[1].push_back(j);
+                    coords[2].push_back(k);
+                }
+            }
+        }
+    }
+    hsize_t num = coords[0].size();
+
+    auto path = dir / "sparse.h5";
+    std::filesystem::create_directories(dir);
+    auto dump = [&]() -> void {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        auto ihandle = handle.createGroup("indices");
+        hdf5_utils::spawn_numeric_data<int>(ihandle, "0", H5::PredType::NATIVE_UINT8, coords[0]);
+        hdf5_utils::spawn_numeric_data<int>(ihandle, "1", H5::PredType::NATIVE_UINT16, coords[1]);
+        hdf5_utils::spawn_numeric_data<int>(ihandle, "2", H5::PredType::NATIVE_UINT64, coords[2]);
+    };
+
+    auto check = [&](const std::string& msg) -> void {
+        dump();
+        H5::H5File handle(path, H5F_ACC_RDONLY);
+        auto ihandle = handle.openGroup("indices");
+        for (hsize_t buffer_size : { 1, 7, 50, 10000 }) {
+            for (int nthreads : { 1, 3 }) {
+                for (bool mmap : { false, true }) {
+                    auto run = [&]() -> void {
+                        takane::internal_bumpy_array::validate_sparse_indices(ihandle, dims, num, buffer_size, nthreads, mmap);
+                    };
+                    if (msg.empty()) {
+                        run();
+                    } else {
+                        EXPECT_ANY_THROW({
+                            try {
+                                run();
+                            } catch (std::exception& e) {
+                                EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+                                throw;
+                            }
+                        });
+                    }
+                }
+            }
+        }
+    };
+
+    check("");
+
+    // Errors are reported in the same order as a serial scan.
+    auto original = coords;
+    hsize_t late = num - 5, early = num / 3;
+    coords[2][late] = coords[2][late - 1] + 1;
+    coords[2][late + 1] = 0;
+    coords[0][early] = coords[0][early - 1];
+    coords[1][early] = coords[1][early - 1];
+    coords[2][early] = coords[2][early - 1];
+    check("duplicate coordinates");
+
+    coords = original;
+    coords[2][late] = 0;
+    coords[0][early + 1] = 100;
+    check("indices/0' should be less than");
+
+    coords = original;
+    coords[2][late] = 100;
+    std::swap(coords[0][early], coords[0][early + 1]);
+    std::swap(coords[1][early], coords[1][early + 1]);
+    std::swap(coords[2][early], coords[2][early + 1]);
+    check("strictly increasing");
+
+    coords = original;
+    coords[1][0] = 5;
+    check("indices/1' should be less than");
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include "takane/utils_cache.hpp"
+
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+TEST(SessionCache, Basic) {
+    takane::internal_cache::SessionCache cache;
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_FALSE(cache.find<std::vector<int> >("foo"));
+
+    cache.store("foo", std::make_shared<const std::vector<int> >(std::vector<int>{ 1, 2, 3 }));
+    cache.store("bar", std::make_shared<const std::string>("whee"));
+    EXPECT_EQ(cache.size(), 2u);
+
+    auto foo = cache.find<std::vector<int> >("foo");
+    ASSERT_TRUE(foo);
+    EXPECT_EQ(*foo, std::vector<int>({ 1, 2, 3 }));
+    auto bar = cache.find<std::string>("bar");
+    ASSERT_TRUE(bar);
+    EXPECT_EQ(*bar, "whee");
+}
+
+TEST(SessionCache, Snapshot) {
+    std::filesystem::path dir = "TEST_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+
+    auto dump = [](const std::filesystem::path& path, const std::string& contents) -> void {
+        std::ofstream output(path, std::ios::binary);
+        output << contents;
+    };
+
+    dump(dir / "A", "abcdefghijklmnopqrstuvwxyz");
+    dump(dir / "B", "abcdefghijklmnopqrstuvwxyz");
+    dump(dir / "C", "abcdefghijklmnopqrstuvwxyZ");
+    dump(dir / "D", "");
+    dump(dir / "E", std::string("abc\0def", 7));
+
+    auto sA = takane::internal_cache::snapshot_files({ dir / "A" });
+    EXPECT_EQ(sA, "26:abcdefghijklmnopqrstuvwxyz;");
+    EXPECT_EQ(sA, takane::internal_cache::snapshot_files({ dir / "B" }));
+    EXPECT_NE(sA, takane::internal_cache::snapshot_files({ dir / "C" }));
+    EXPECT_NE(sA, takane::internal_cache::snapshot_files({ dir / "D" }));
+    EXPECT_NE(sA, takane::internal_cache::snapshot_files({ dir / "A", dir / "D" }));
+    EXPECT_EQ(takane::internal_cache::snapshot_files({ dir / "A", dir / "C" }), takane::internal_cache::snapshot_files({ dir / "B", dir / "C" }));
+    EXPECT_EQ(takane::internal_cache::snapshot_files({ dir / "E" }), std::string("7:abc\0def;", 10)); // embedded nulls are preserved.
+
+    EXPECT_ANY_THROW(takane::internal_cache::snapshot_files({ dir / "missing" }));
+}
+
+TEST(SessionCache, IdentifyFile) {
+    std::filesystem::path dir = "TEST_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+
+    auto dump = [](const std::filesystem::path& path, const std::string& contents) -> void {
+        std::ofstream output(path, std::ios::binary);
+        output << contents;
+    };
+
+    dump(dir / "A", "abcdefghijklmnopqrstuvwxyz");
+    dump(dir / "B", "abcdefghijklmnopqrstuvwxyz");
+
+    auto iA = takane::internal_cache::identify_file(dir / "A");
+    ASSERT_TRUE(iA.has_value());
+    EXPECT_EQ(iA, takane::internal_cache::identify_file(dir / "A"));
+    EXPECT_EQ(iA, takane::internal_cache::identify_file(std::filesystem::absolute(dir / "A")));
+    EXPECT_NE(iA, takane::internal_cache::identify_file(dir / "B")); // different paths.
+
+    // Changes in size or modification time are detected.
+    dump(dir / "A", "abcdefghijklmnopqrstuvwxyz0123456789");
+    auto iA2 = takane::internal_cache::identify_file(dir / "A");
+    EXPECT_NE(iA, iA2);
+    std::filesystem::last_write_time(dir / "A", std::filesystem::last_write_time(dir / "A") + std::chrono::seconds(1));
+    EXPECT_NE(iA2, takane::internal_cache::identify_file(dir / "A"));
+
+    EXPECT_FALSE(takane::internal_cache::identify_file(dir / "missing").has_value());
+
+#if defined(__unix__) || defined(__APPLE__)
+    // Replacing the file is detected, even if the size and modification time are the same.
+    auto iB = takane::internal_cache::identify_file(dir / "B");
+    auto mtime = std::filesystem::last_write_time(dir / "B");
+    dump(dir / "C", "abcdefghijklmnopqrstuvwxyz");
+    std::filesystem::last_write_time(dir / "C", mtime);
+    std::filesystem::rename(dir / "C", dir / "B");
+    EXPECT_EQ(std::filesystem::last_write_time(dir / "B"), mtime);
+    EXPECT_NE(iB, takane::internal_cache::identify_file(dir / "B"));
+#endif
+}
+
+TEST(SessionCache, Usable) {
+    struct MockOptions {
+        bool cache_results = true;
+        std::function<void()> custom_global_validate;
+        std::shared_ptr<takane::internal_cache::SessionCache> session_cache;
+    };
+
+    MockOptions opts;
+    EXPECT_EQ(takane::internal_cache::usable_session_cache(opts), nullptr);
+
+    opts.session_cache = std::make_shared<takane::internal_cache::SessionCache>();
+    EXPECT_EQ(takane::internal_cache::usable_session_cache(opts), opts.session_cache.get());
+
+    opts.cache_results = false;
+    EXPECT_EQ(takane::internal_cache::usable_session_cache(opts), nullptr);
+
+    opts.cache_results = true;
+    opts.custom_global_validate = []() -> void {};
+    EXPECT_EQ(takane::internal_cache::usable_session_cache(opts), nullptr);
+}
+
+TEST(SessionCache, Scope) {
+    std::shared_ptr<takane::internal_cache::SessionCache> cache;
+    {
+        takane::internal_cache::SessionScope outer(cache, true);
+        ASSERT_TRUE(cache);
+        auto ptr = cache.get();
+        {
+            takane::internal_cache::SessionScope inner(cache, true);
+            EXPECT_EQ(cache.get(), ptr); // nested scopes re-use the existing cache.
+        }
+        EXPECT_EQ(cache.get(), ptr);
+    }
+    EXPECT_FALSE(cache);
+
+    {
+        takane::internal_cache::SessionScope disabled(cache, false);
+        EXPECT_FALSE(cache);
+    }
+
+    // Caller-supplied caches are left alone.
+    cache = std::make_shared<takane::internal_cache::SessionCache>();
+    auto ptr = cache.get();
+    {
+        takane::internal_cache::SessionScope scope(cache, true);
+    }
+    EXPECT_EQ(cache.get(), ptr);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "takane/utils_date.hpp"
+
+#include <string>
+#include <vector>
+
+static bool fast_date(const std::string& x) {
+    return takane::internal_date::is_date_fast(x.c_str(), x.size());
+}
+
+static bool fast_rfc3339(const std::string& x) {
+    return takane::internal_date::is_rfc3339_fast(x.c_str(), x.size());
+}
+
+TEST(DateFastPath, Date) {
+    EXPECT_TRUE(fast_date("2023-01-31"));
+    EXPECT_TRUE(fast_date("1999-12-01"));
+    EXPECT_TRUE(fast_date("2024-02-29"));
+    EXPECT_TRUE(fast_date("2000-02-29"));
+
+    EXPECT_FALSE(fast_date("2023-02-29"));
+    EXPECT_FALSE(fast_date("1900-02-29"));
+    EXPECT_FALSE(fast_date("2023-04-31"));
+    EXPECT_FALSE(fast_date("2023-13-01"));
+    EXPECT_FALSE(fast_date("2023-00-01"));
+    EXPECT_FALSE(fast_date("2023-01-00"));
+    EXPECT_FALSE(fast_date("2023/01/01"));
+    EXPECT_FALSE(fast_date("2023-0a-01"));
+    EXPECT_FALSE(fast_date("2023-01-1:"));
+    EXPECT_FALSE(fast_date("2023-01-01 "));
+    EXPECT_FALSE(fast_date("23-01-01"));
+}
+
+TEST(DateFastPath, Rfc3339) {
+    EXPECT_TRUE(fast_rfc3339("2023-01-31T12:34:56Z"));
+    EXPECT_TRUE(fast_rfc3339("2023-01-31T00:00:00+09:30"));
+    EXPECT_TRUE(fast_rfc3339("2023-01-31T23:59:59-05:00"));
+
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T24:00:00Z"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:60:00Z"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:34:60Z")); // leap seconds go to the fallback.
+    EXPECT_FALSE(fast_rfc3339("2023-02-31T12:34:56Z"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31 12:34:56Z"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:34:56z"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:34:56.789Z")); // fractional seconds go to the fallback.
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:34:56*05:00"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:34:56+24:00"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:34:56-00:00"));
+    EXPECT_FALSE(fast_rfc3339("2023-01-31T12:34:56+0500"));
+}
+
+TEST(DateFastPath, Consistency) {
+    // Every string accepted by the fast path must also be accepted by ritsuko,
+    // and the combined check must agree with ritsuko for everything else.
+    std::vector<std::string> dates {
+        "2023-01-31", "2024-02-29", "2023-02-29", "2023-13-01", "2023-1-01", "foobar", "", "2023-01-31T"
+    };
+    for (const auto& x : dates) {
+        bool expected = ritsuko::is_date(x.c_str(), x.size());
+        if (fast_date(x)) {
+            EXPECT_TRUE(expected) << x;
+        }
+        EXPECT_EQ(takane::internal_date::is_date(x.c_str(), x.size()), expected) << x;
+    }
+
+    std::vector<std::string> datetimes {
+        "2023-01-31T12:34:56Z", "2023-01-31T12:34:56+09:30", "2023-01-31T12:34:56.789Z", "2023-01-31T12:34:60Z",
+        "2023-01-31T24:00:00Z", "2023-02-31T12:34:56Z", "2023-01-31", "foobar", ""
+    };
+    for (const auto& x : datetimes) {
+        bool expected = ritsuko::is_rfc3339(x.c_str(), x.size());
+        if (fast_rfc3339(x)) {
+            EXPECT_TRUE(expected) << x;
+        }
+        EXPECT_EQ(takane::internal_date::is_rfc3339(x.c_str(), x.size()), expected) << x;
+    }
+}
@@ -54,6 +54,21 @@ TEST_F(Hdf5FactorTest, Levels) {
         expect_error_levels("duplicated factor level", handle, "foobar", 10000);
         EXPECT_EQ(takane::internal_factor::validate_factor_levels(handle, "blah", 10000), nlevels);
     }
+
+    // A huge declared length fails at the first duplicate without preallocating for every level.
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hsize_t dims = static_cast<hsize_t>(1) << 40;
+        H5::DataSpace dspace(1, &dims);
+        H5::DSetCreatPropList cplist;
+        hsize_t chunk = 1000;
+        cplist.setChunk(1, &chunk);
+        handle.createDataSet("huge", H5::StrType(0, 10), dspace, cplist);
+    }
+    {
+        H5::H5File handle(path, H5F_ACC_RDONLY);
+        expect_error_levels("duplicated factor level", handle, "huge", 10000);
+    }
 }
 
 TEST_F(Hdf5FactorTest, Codes) {
@@ -3,6 +3,10 @@
 
 #include "takane/utils_files.hpp"
 
+#ifdef TAKANE_HAS_PREAD
+#error "TAKANE_HAS_PREAD should not be visible outside of utils_files.hpp"
+#endif
+
 #include "utils.h"
 
 struct FileSignatureTest : public::testing::Test {
@@ -114,6 +118,25 @@ TEST_F(FileSignatureTest, Extraction) {
     EXPECT_EQ(cbuffer[3], 'b');
 }
 
+TEST_F(FileSignatureTest, Prefix) {
+    initialize_directory(dir);
+    auto path = dir / "foo.txt";
+
+    {
+        std::ofstream handle(path);
+        handle << "FOObar";
+    }
+
+    unsigned char buffer[10];
+    EXPECT_EQ(takane::internal_files::read_prefix(path, buffer, 4), 4u);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buffer), 4), "FOOb");
+    EXPECT_EQ(takane::internal_files::read_prefix(path, buffer, 10), 6u); // truncated at the end of the file.
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buffer), 6), "FOObar");
+
+    std::filesystem::remove(path);
+    expect_error_extract("failed to open", path, buffer, 4);
+}
+
 TEST(IsIndexed, Basic) {
     takane::internal_json::JsonObjectMap obj;
     EXPECT_FALSE(takane::internal_files::is_indexed(obj));
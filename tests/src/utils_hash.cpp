@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "takane/utils_hash.hpp"
+
+#include <string>
+#include <vector>
+#include <limits>
+
+TEST(StringSet, Basic) {
+    takane::internal_hash::StringSet present;
+    EXPECT_FALSE(present.contains("foo"));
+    EXPECT_EQ(present.size(), 0u);
+    EXPECT_TRUE(present.empty());
+
+    EXPECT_TRUE(present.insert("foo"));
+    EXPECT_TRUE(present.insert("bar"));
+    EXPECT_TRUE(present.insert(""));
+    EXPECT_FALSE(present.insert("foo"));
+    EXPECT_FALSE(present.insert(""));
+    EXPECT_EQ(present.size(), 3u);
+    EXPECT_FALSE(present.empty());
+
+    EXPECT_TRUE(present.contains("foo"));
+    EXPECT_TRUE(present.contains("bar"));
+    EXPECT_TRUE(present.contains(""));
+    EXPECT_FALSE(present.contains("whee"));
+    EXPECT_FALSE(present.contains("fo"));
+
+    // Handles embedded nulls correctly.
+    std::string withnull("foo\0bar", 7);
+    EXPECT_TRUE(present.insert(withnull));
+    EXPECT_FALSE(present.insert(withnull));
+    EXPECT_TRUE(present.contains(withnull));
+    EXPECT_TRUE(present.contains("foo"));
+}
+
+TEST(StringSet, Growth) {
+    takane::internal_hash::StringSet present;
+
+    // Using a variety of string lengths to check the length prefixes.
+    std::vector<std::string> all;
+    for (size_t i = 0; i < 5000; ++i) {
+        all.push_back(std::string(i % 300, 'a') + std::to_string(i));
+    }
+
+    for (const auto& x : all) {
+        EXPECT_TRUE(present.insert(x));
+    }
+    EXPECT_EQ(present.size(), all.size());
+
+    for (const auto& x : all) {
+        EXPECT_FALSE(present.insert(x));
+        EXPECT_TRUE(present.contains(x));
+        EXPECT_FALSE(present.contains(x + "_"));
+    }
+    EXPECT_EQ(present.size(), all.size());
+}
+
+TEST(StringSet, Reserve) {
+    takane::internal_hash::StringSet present;
+    present.reserve(1000, 5000);
+    for (size_t i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(present.insert(std::to_string(i)));
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+        EXPECT_FALSE(present.insert(std::to_string(i)));
+    }
+    EXPECT_EQ(present.size(), 1000u);
+
+    // Reserving on a non-empty set preserves its contents.
+    present.reserve(100000);
+    for (size_t i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(present.contains(std::to_string(i)));
+    }
+    EXPECT_FALSE(present.contains("1000"));
+}
+
+TEST(StringSet, ReserveLimits) {
+    EXPECT_LE(takane::internal_hash::StringSet::max_reserve(), static_cast<size_t>(1) << 20);
+
+    // Reservations are capped before they would overflow, so this throws
+    // bad_alloc or length_error instead of looping forever.
+    takane::internal_hash::StringSet present;
+    EXPECT_ANY_THROW(present.reserve(std::numeric_limits<size_t>::max()));
+    EXPECT_ANY_THROW(present.reserve(static_cast<size_t>(1) << 62));
+    EXPECT_TRUE(present.insert("foo"));
+}
+
+TEST(RecentStrings, Basic) {
+    takane::internal_hash::RecentStrings recent(16);
+    size_t calls = 0;
+    auto is_upper = [&](std::string_view x) -> bool {
+        ++calls;
+        for (auto c : x) {
+            if (c < 'A' || c > 'Z') {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    EXPECT_TRUE(recent.check("FOO", is_upper));
+    EXPECT_TRUE(recent.check("FOO", is_upper));
+    EXPECT_EQ(calls, 1u);
+
+    // Failures are never cached.
+    EXPECT_FALSE(recent.check("bar", is_upper));
+    EXPECT_FALSE(recent.check("bar", is_upper));
+    EXPECT_EQ(calls, 3u);
+
+    // Empty strings can be cached.
+    EXPECT_TRUE(recent.check("", is_upper));
+    EXPECT_TRUE(recent.check("", is_upper));
+    EXPECT_EQ(calls, 4u);
+
+    // Long strings are never cached.
+    std::string long_string(100, 'A');
+    EXPECT_TRUE(recent.check(long_string, is_upper));
+    EXPECT_TRUE(recent.check(long_string, is_upper));
+    EXPECT_EQ(calls, 6u);
+}
+
+TEST(RecentStrings, Collisions) {
+    // Many distinct values in a tiny cache, to check that evicted entries are correctly re-checked.
+    takane::internal_hash::RecentStrings recent(4);
+    size_t calls = 0;
+    auto even = [&](std::string_view x) -> bool {
+        ++calls;
+        return (x.back() - '0') % 2 == 0;
+    };
+
+    for (int rep = 0; rep < 3; ++rep) {
+        for (int i = 0; i < 100; ++i) {
+            auto x = std::to_string(i);
+            EXPECT_EQ(recent.check(x, even), i % 2 == 0);
+        }
+    }
+    EXPECT_GT(calls, 150u); // odd values are always re-checked, plus evictions of even values.
+    EXPECT_LE(calls, 300u);
+}
@@ -0,0 +1,617 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "takane/utils_hdf5.hpp"
+#include "takane/utils_parallel.hpp"
+
+#include "utils.h"
+
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+#include <mutex>
+#include <functional>
+
+struct Hdf5BlockTest : public::testing::Test {
+    static std::string testpath() {
+        return "TEST_hdf5utils.h5";
+    }
+
+    template<typename Type_>
+    static std::vector<Type_> collect(const H5::DataSet& handle, hsize_t buffer_size, bool memory_map) {
+        auto len = ritsuko::hdf5::get_1d_length(handle.getSpace(), false);
+        std::vector<Type_> output;
+        hsize_t last = 0;
+        takane::internal_hdf5::iterate_1d_blocks<Type_>(handle, len, buffer_size, memory_map, [&](hsize_t start, hsize_t count, const Type_* ptr) {
+            EXPECT_EQ(start, last);
+            EXPECT_GT(count, 0u);
+            output.insert(output.end(), ptr, ptr + count);
+            last += count;
+        });
+        return output;
+    }
+};
+
+TEST_F(Hdf5BlockTest, Contiguous) {
+    auto path = testpath();
+
+    std::vector<uint64_t> values(1234);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = i * 7 + 1;
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_numeric_data<uint64_t>(handle, "native", H5::PredType::NATIVE_UINT64, values);
+        hdf5_utils::spawn_numeric_data<uint64_t>(handle, "converted", H5::PredType::NATIVE_UINT16, values);
+        hdf5_utils::spawn_data(handle, "empty", 0, H5::PredType::NATIVE_UINT64);
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_RDONLY);
+        auto nhandle = handle.openDataSet("native");
+        EXPECT_TRUE(takane::internal_hdf5::map_1d_dataset<uint64_t>(nhandle, values.size()).mapped());
+        EXPECT_FALSE(takane::internal_hdf5::map_1d_dataset<uint32_t>(nhandle, values.size()).mapped());
+        EXPECT_EQ(collect<uint64_t>(nhandle, 100, true), values);
+        EXPECT_EQ(collect<uint64_t>(nhandle, 100, false), values);
+        EXPECT_EQ(collect<uint64_t>(nhandle, 10000, true), values);
+
+        // Type conversion means that we can't map it.
+        auto chandle = handle.openDataSet("converted");
+        EXPECT_FALSE(takane::internal_hdf5::map_1d_dataset<uint64_t>(chandle, values.size()).mapped());
+        EXPECT_EQ(collect<uint64_t>(chandle, 100, true), values);
+
+        auto ehandle = handle.openDataSet("empty");
+        EXPECT_FALSE(takane::internal_hdf5::map_1d_dataset<uint64_t>(ehandle, 0).mapped());
+        EXPECT_TRUE(collect<uint64_t>(ehandle, 100, true).empty());
+    }
+
+    // Files opened for writing are never mapped.
+    {
+        H5::H5File handle(path, H5F_ACC_RDWR);
+        auto nhandle = handle.openDataSet("native");
+        EXPECT_FALSE(takane::internal_hdf5::map_1d_dataset<uint64_t>(nhandle, values.size()).mapped());
+        EXPECT_EQ(collect<uint64_t>(nhandle, 100, true), values);
+    }
+}
+
+TEST_F(Hdf5BlockTest, Chunked) {
+    auto path = testpath();
+
+    std::vector<int32_t> values(5000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int32_t>(i % 97) - 50;
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hsize_t len = values.size();
+        H5::DataSpace dspace(1, &len);
+        H5::DSetCreatPropList cplist;
+        hsize_t chunk = 311;
+        cplist.setChunk(1, &chunk);
+        cplist.setDeflate(6);
+        auto dhandle = handle.createDataSet("compressed", H5::PredType::NATIVE_INT32, dspace, cplist);
+        dhandle.write(values.data(), H5::PredType::NATIVE_INT32);
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_RDONLY);
+        auto dhandle = handle.openDataSet("compressed");
+        EXPECT_FALSE(takane::internal_hdf5::map_1d_dataset<int32_t>(dhandle, values.size()).mapped());
+        EXPECT_EQ(collect<int32_t>(dhandle, 1000, true), values);
+        EXPECT_EQ(collect<int32_t>(dhandle, 10, false), values);
+    }
+}
+
+TEST_F(Hdf5BlockTest, IntegerDispatch) {
+    auto path = testpath();
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_data(handle, "u8", 10, H5::PredType::NATIVE_UINT8);
+        hdf5_utils::spawn_data(handle, "u16", 10, H5::PredType::NATIVE_UINT16);
+        hdf5_utils::spawn_data(handle, "u32", 10, H5::PredType::NATIVE_UINT32);
+        hdf5_utils::spawn_data(handle, "i8", 10, H5::PredType::NATIVE_INT8);
+        hdf5_utils::spawn_data(handle, "i32", 10, H5::PredType::NATIVE_INT32);
+        hdf5_utils::spawn_data(handle, "i64", 10, H5::PredType::NATIVE_INT64);
+        hdf5_utils::spawn_data(handle, "f64", 10, H5::PredType::NATIVE_DOUBLE);
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_RDONLY);
+        auto check = [&](const char* name, auto dflt, size_t expected_size) -> void {
+            typedef decltype(dflt) Default_;
+            auto dhandle = handle.openDataSet(name);
+            takane::internal_hdf5::dispatch_integer_type<Default_>(dhandle, [&](auto tag) -> void {
+                typedef decltype(tag) Type_;
+                EXPECT_EQ(sizeof(Type_), expected_size) << name;
+                EXPECT_EQ(std::is_signed<Type_>::value, std::is_signed<Default_>::value) << name;
+            });
+        };
+
+        check("u8", uint64_t(), 1);
+        check("u16", uint64_t(), 2);
+        check("u32", uint64_t(), 4);
+        check("f64", uint64_t(), 8);
+
+        // Unsigned types are promoted when the default is signed.
+        check("u8", int32_t(), 2);
+        check("u16", int32_t(), 4);
+        check("u32", int32_t(), 4); // not representable, falls back to the default.
+        check("u32", int64_t(), 8);
+        check("i8", int32_t(), 1);
+        check("i32", int32_t(), 4);
+        check("i64", int32_t(), 4);
+        check("i8", uint64_t(), 8);
+    }
+
+    // Checking that the values are correctly read at the native width.
+    {
+        std::vector<uint64_t> values { 0, 1, 2, 255, 17 };
+        {
+            H5::H5File whandle(path, H5F_ACC_TRUNC);
+            hdf5_utils::spawn_numeric_data<uint64_t>(whandle, "small", H5::PredType::NATIVE_UINT8, values);
+        }
+
+        H5::H5File rhandle(path, H5F_ACC_RDONLY);
+        auto dhandle = rhandle.openDataSet("small");
+        std::vector<uint64_t> output;
+        takane::internal_hdf5::iterate_1d_integer_blocks<uint64_t>(dhandle, values.size(), 2, true, [&](hsize_t, hsize_t count, const auto* ptr) -> void {
+            EXPECT_EQ(sizeof(*ptr), 1u);
+            output.insert(output.end(), ptr, ptr + count);
+        });
+        EXPECT_EQ(output, values);
+    }
+}
+
+TEST_F(Hdf5BlockTest, Concurrent) {
+    auto path = testpath();
+
+    std::vector<uint32_t> values(1000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = i * 3;
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_numeric_data<uint32_t>(handle, "foo", H5::PredType::NATIVE_UINT32, values);
+    }
+
+    H5::H5File handle(path, H5F_ACC_RDONLY);
+    auto dhandle = handle.openDataSet("foo");
+
+    for (int mapped = 0; mapped < 2; ++mapped) {
+        takane::internal_hdf5::ConcurrentBlockReader<uint32_t> reader(dhandle, values.size(), mapped);
+        std::vector<uint32_t> output(values.size());
+        std::vector<hsize_t> boundaries { 0, 10, 10, 333, 999, 1000 };
+
+        takane::internal_parallel::parallelize(boundaries.size() - 1, 3, [&](size_t job) -> void {
+            hsize_t last = boundaries[job];
+            reader.iterate(boundaries[job], boundaries[job + 1], 50, [&](hsize_t start, hsize_t count, const uint32_t* ptr) -> void {
+                EXPECT_EQ(start, last);
+                std::copy_n(ptr, count, output.begin() + start);
+                last += count;
+            });
+            EXPECT_EQ(last, boundaries[job + 1]);
+        });
+
+        EXPECT_EQ(output, values);
+    }
+
+    // Multiple readers can share a mutex and fetch arbitrary ranges.
+    for (int mapped = 0; mapped < 2; ++mapped) {
+        std::mutex lock;
+        takane::internal_hdf5::ConcurrentBlockReader<uint32_t> reader1(dhandle, values.size(), mapped, lock);
+        takane::internal_hdf5::ConcurrentBlockReader<uint64_t> reader2(dhandle, values.size(), mapped, lock);
+        std::vector<uint32_t> buffer1;
+        std::vector<uint64_t> buffer2;
+
+        auto ptr1 = reader1.fetch(123, 45, buffer1);
+        EXPECT_EQ(std::vector<uint32_t>(ptr1, ptr1 + 45), std::vector<uint32_t>(values.begin() + 123, values.begin() + 168));
+        auto ptr2 = reader2.fetch(900, 100, buffer2);
+        EXPECT_EQ(std::vector<uint64_t>(ptr2, ptr2 + 100), std::vector<uint64_t>(values.begin() + 900, values.end()));
+    }
+}
+
+TEST_F(Hdf5BlockTest, Reduce) {
+    auto path = testpath();
+
+    std::vector<uint32_t> values(1000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = (i * 7) % 101;
+    }
+    uint64_t expected = 0;
+    for (auto v : values) {
+        expected += v;
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_numeric_data<uint32_t>(handle, "foo", H5::PredType::NATIVE_UINT32, values);
+        hdf5_utils::spawn_numeric_data<uint64_t>(handle, "big", H5::PredType::NATIVE_UINT64, { 1, static_cast<uint64_t>(-1), 0 });
+        hdf5_utils::spawn_numeric_data<uint64_t>(handle, "empty", H5::PredType::NATIVE_UINT64, {});
+        hdf5_utils::spawn_numeric_data<uint8_t>(handle, "small", H5::PredType::NATIVE_UINT8, std::vector<uint8_t>(1000, 255));
+    }
+
+    H5::H5File handle(path, H5F_ACC_RDONLY);
+    auto dhandle = handle.openDataSet("foo");
+    auto bhandle = handle.openDataSet("big");
+    auto ehandle = handle.openDataSet("empty");
+    auto shandle = handle.openDataSet("small");
+
+    for (int mapped = 0; mapped < 2; ++mapped) {
+        for (int nthreads : { 1, 3 }) {
+            for (hsize_t buffer_size : { 1, 7, 100, 5000 }) {
+                auto sum = takane::internal_hdf5::sum_1d_integers(dhandle, values.size(), buffer_size, nthreads, mapped);
+                ASSERT_TRUE(sum.has_value());
+                EXPECT_EQ(*sum, expected);
+
+                EXPECT_FALSE(takane::internal_hdf5::sum_1d_integers(bhandle, 3, buffer_size, nthreads, mapped).has_value());
+
+                auto esum = takane::internal_hdf5::sum_1d_integers(ehandle, 0, buffer_size, nthreads, mapped);
+                ASSERT_TRUE(esum.has_value());
+                EXPECT_EQ(*esum, 0u);
+
+                // Narrow types are summed at their native width.
+                auto ssum = takane::internal_hdf5::sum_1d_integers(shandle, 1000, buffer_size, nthreads, mapped);
+                ASSERT_TRUE(ssum.has_value());
+                EXPECT_EQ(*ssum, 255000u);
+
+                // Blocks are visited in order within each job, and jobs are merged in order.
+                auto visited = takane::internal_hdf5::reduce_1d_blocks<uint32_t>(
+                    dhandle,
+                    values.size(),
+                    buffer_size,
+                    nthreads,
+                    mapped,
+                    std::vector<uint32_t>(),
+                    [](std::vector<uint32_t> current, hsize_t start, hsize_t count, const uint32_t* ptr) -> std::vector<uint32_t> {
+                        EXPECT_GT(count, 0u);
+                        EXPECT_EQ(ptr[0], (start * 7) % 101);
+                        current.insert(current.end(), ptr, ptr + count);
+                        return current;
+                    },
+                    [](std::vector<uint32_t> left, const std::vector<uint32_t>& right) -> std::vector<uint32_t> {
+                        left.insert(left.end(), right.begin(), right.end());
+                        return left;
+                    }
+                );
+                EXPECT_EQ(visited, values);
+            }
+        }
+    }
+}
+
+TEST_F(Hdf5BlockTest, MultiRead) {
+    auto path = testpath();
+
+    std::vector<uint32_t> first(500);
+    std::vector<double> second(500);
+    for (size_t i = 0; i < first.size(); ++i) {
+        first[i] = i * 2;
+        second[i] = i * 0.5;
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_numeric_data<uint32_t>(handle, "first", H5::PredType::NATIVE_UINT16, first);
+        hdf5_utils::spawn_numeric_data<double>(handle, "second", H5::PredType::NATIVE_DOUBLE, second);
+    }
+
+    H5::H5File handle(path, H5F_ACC_RDONLY);
+    auto fhandle = handle.openDataSet("first");
+    auto shandle = handle.openDataSet("second");
+
+    takane::internal_hdf5::MultiRead batch;
+    EXPECT_TRUE(batch.empty());
+    std::vector<uint32_t> fbuffer(77);
+    std::vector<double> sbuffer(77);
+    batch.add(fhandle, fbuffer.data());
+    batch.add(shandle, sbuffer.data());
+    EXPECT_FALSE(batch.empty());
+
+    batch.run(400, 77, first.size());
+    EXPECT_EQ(fbuffer, std::vector<uint32_t>(first.begin() + 400, first.begin() + 477));
+    EXPECT_EQ(sbuffer, std::vector<double>(second.begin() + 400, second.begin() + 477));
+
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+    batch.run(0, 10, first.size()); // no-op.
+
+    // Works with the deferred fetches from the concurrent reader.
+    for (int mapped = 0; mapped < 2; ++mapped) {
+        takane::internal_hdf5::ConcurrentBlockReader<uint32_t> freader(fhandle, first.size(), mapped);
+        takane::internal_hdf5::ConcurrentBlockReader<double> sreader(shandle, second.size(), mapped);
+        std::vector<uint32_t> fbuffer2;
+        std::vector<double> sbuffer2;
+        batch.clear();
+        auto fptr = freader.fetch(10, 20, fbuffer2, batch);
+        auto sptr = sreader.fetch(10, 20, sbuffer2, batch);
+        EXPECT_FALSE(batch.empty()); // 'first' can never be mapped as it needs conversion.
+        batch.run(10, 20, first.size());
+        EXPECT_EQ(std::vector<uint32_t>(fptr, fptr + 20), std::vector<uint32_t>(first.begin() + 10, first.begin() + 30));
+        EXPECT_EQ(std::vector<double>(sptr, sptr + 20), std::vector<double>(second.begin() + 10, second.begin() + 30));
+    }
+}
+
+TEST_F(Hdf5BlockTest, IndexedChildren) {
+    auto path = testpath();
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        auto ghandle = handle.createGroup("foo");
+        hdf5_utils::spawn_data(ghandle, "0", 10, H5::PredType::NATIVE_INT32);
+        ghandle.createGroup("2");
+        hdf5_utils::spawn_data(ghandle, "10", 10, H5::PredType::NATIVE_INT32);
+        hdf5_utils::spawn_data(ghandle, "03", 10, H5::PredType::NATIVE_INT32);
+        hdf5_utils::spawn_data(ghandle, "whee", 10, H5::PredType::NATIVE_INT32);
+        hdf5_utils::spawn_data(ghandle, "99999999999999999999999", 10, H5::PredType::NATIVE_INT32);
+        H5Lcreate_soft("/foo/10", ghandle.getId(), "4", H5P_DEFAULT, H5P_DEFAULT);
+        H5Lcreate_soft("/foo/missing", ghandle.getId(), "5", H5P_DEFAULT, H5P_DEFAULT);
+        handle.createGroup("empty");
+    }
+
+    H5::H5File handle(path, H5F_ACC_RDONLY);
+    {
+        takane::internal_hdf5::IndexedChildren children(handle.openGroup("foo"), 4);
+        EXPECT_EQ(children.size(), 8u);
+        EXPECT_TRUE(children.exists(0));
+        EXPECT_EQ(children.type(0), H5O_TYPE_DATASET);
+        EXPECT_FALSE(children.exists(1));
+        EXPECT_TRUE(children.exists(2));
+        EXPECT_EQ(children.type(2), H5O_TYPE_GROUP);
+        EXPECT_FALSE(children.exists(3)); // leading zeros are not allowed.
+    }
+
+    {
+        takane::internal_hdf5::IndexedChildren children(handle.openGroup("foo"), 11);
+        EXPECT_TRUE(children.exists(10));
+        EXPECT_EQ(children.type(10), H5O_TYPE_DATASET);
+        EXPECT_TRUE(children.exists(4)); // soft links are followed.
+        EXPECT_EQ(children.type(4), H5O_TYPE_DATASET);
+        EXPECT_TRUE(children.exists(5)); // dangling soft links still exist, but without a type.
+        EXPECT_EQ(children.type(5), H5O_TYPE_UNKNOWN);
+    }
+
+    {
+        takane::internal_hdf5::IndexedChildren children(handle.openGroup("empty"), 2);
+        EXPECT_EQ(children.size(), 0u);
+        EXPECT_FALSE(children.exists(0));
+        EXPECT_FALSE(children.exists(1));
+    }
+}
+
+TEST_F(Hdf5BlockTest, Strings) {
+    auto path = testpath();
+    std::vector<std::string> values { "A", "", "BBBBB", "CC", "abcdefgh", "DDD" };
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_string_data(handle, "variable", H5T_VARIABLE, values);
+        hdf5_utils::spawn_string_data(handle, "fixed", 5, values); // longest string is truncated to fill the entire width.
+    }
+
+    H5::H5File handle(path, H5F_ACC_RDONLY);
+    for (hsize_t buffer_size : { 1, 4, 100 }) {
+        auto collect = [&](const char* name) -> std::vector<std::string> {
+            auto dhandle = handle.openDataSet(name);
+            std::vector<std::string> output;
+            takane::internal_hdf5::iterate_1d_strings(dhandle, values.size(), buffer_size, [&](hsize_t i, std::string_view x) -> void {
+                EXPECT_EQ(i, output.size());
+                output.emplace_back(x);
+            });
+            return output;
+        };
+
+        EXPECT_EQ(collect("variable"), values);
+        auto expected = values;
+        expected[4] = "abcde";
+        EXPECT_EQ(collect("fixed"), expected);
+    }
+}
+
+TEST_F(Hdf5BlockTest, StringsVariableArena) {
+    auto path = testpath();
+
+    // Strings that are larger than each chunk of the arena, mixed with small strings.
+    std::vector<std::string> values;
+    for (size_t i = 0; i < 20; ++i) {
+        values.emplace_back(i % 3 == 0 ? 1500000 + i : i, 'a' + i);
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_string_data(handle, "variable", H5T_VARIABLE, values);
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_RDONLY);
+        auto dhandle = handle.openDataSet("variable");
+        for (hsize_t buffer_size : { 1, 7, 100 }) {
+            // Repeating to check that the recycled chunks are correctly re-used.
+            for (int rep = 0; rep < 2; ++rep) {
+                size_t counter = 0;
+                takane::internal_hdf5::iterate_1d_strings(dhandle, values.size(), buffer_size, [&](hsize_t i, std::string_view x) -> void {
+                    EXPECT_EQ(i, counter);
+                    EXPECT_EQ(x, values[i]);
+                    ++counter;
+                });
+                EXPECT_EQ(counter, values.size());
+            }
+        }
+        takane::internal_hdf5::validate_1d_strings(dhandle, values.size(), 10);
+    }
+
+    // Fails correctly for NULL pointers.
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hsize_t len = 10;
+        H5::DataSpace dspace(1, &len);
+        handle.createDataSet("variable", H5::StrType(0, H5T_VARIABLE), dspace);
+    }
+
+    {
+        H5::H5File handle(path, H5F_ACC_RDONLY);
+        auto dhandle = handle.openDataSet("variable");
+        EXPECT_ANY_THROW({
+            try {
+                takane::internal_hdf5::validate_1d_strings(dhandle, 10, 3);
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr("NULL pointer"));
+                throw;
+            }
+        });
+    }
+}
+
+TEST_F(Hdf5BlockTest, StringsUtf8) {
+    auto path = testpath();
+    std::vector<std::string> values { "A", "caf\xC3\xA9", "\xE2\x82\xAC", "", "ok" };
+    auto bad = values;
+    bad[3] = "\xC3\x28";
+
+    {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hdf5_utils::spawn_string_data(handle, "variable", H5T_VARIABLE, values);
+        hdf5_utils::spawn_string_data(handle, "fixed", 5, values);
+        hdf5_utils::spawn_string_data(handle, "variable_bad", H5T_VARIABLE, bad);
+        hdf5_utils::spawn_string_data(handle, "fixed_bad", 5, bad);
+
+        // Adding a 2-dimensional dataset.
+        std::vector<hsize_t> dims { 3, 2 };
+        H5::DataSpace dspace(2, dims.data());
+        H5::StrType stype(0, H5T_VARIABLE);
+        auto dhandle = handle.createDataSet("matrix", stype, dspace);
+        std::vector<const char*> ptrs { "a", "b", "c", "d", "\xFF", "f" };
+        dhandle.write(ptrs.data(), stype);
+    }
+
+    auto expect_utf8_error = [&](const std::function<void()>& fun) -> void {
+        EXPECT_ANY_THROW({
+            try {
+                fun();
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr("invalid UTF-8"));
+                throw;
+            }
+        });
+    };
+
+    H5::H5File handle(path, H5F_ACC_RDONLY);
+    for (hsize_t buffer_size : { 1, 3, 100 }) {
+        for (auto name : { "variable", "fixed" }) {
+            auto dhandle = handle.openDataSet(name);
+            takane::internal_hdf5::validate_1d_strings(dhandle, values.size(), buffer_size, true);
+        }
+        for (auto name : { "variable_bad", "fixed_bad" }) {
+            auto dhandle = handle.openDataSet(name);
+            takane::internal_hdf5::validate_1d_strings(dhandle, values.size(), buffer_size); // no error if we don't check.
+            expect_utf8_error([&]() -> void { takane::internal_hdf5::validate_1d_strings(dhandle, values.size(), buffer_size, true); });
+        }
+
+        auto mhandle = handle.openDataSet("matrix");
+        std::vector<hsize_t> dims { 3, 2 };
+        std::vector<std::string> collected;
+        takane::internal_hdf5::iterate_nd_strings(mhandle, dims, buffer_size, [&](hsize_t i, std::string_view x) -> void {
+            EXPECT_EQ(i, collected.size());
+            collected.emplace_back(x);
+        });
+        std::vector<std::string> expected { "a", "b", "c", "d", "\xFF", "f" };
+        EXPECT_EQ(collected, expected);
+        expect_utf8_error([&]() -> void { takane::internal_hdf5::validate_nd_strings(mhandle, dims, buffer_size, true); });
+    }
+}
+
+TEST_F(Hdf5BlockTest, VlsPointers) {
+    auto path = testpath();
+
+    // Strings are interleaved throughout the heap, and some are empty or NUL-terminated.
+    std::string heap = "xx caf\xC3\xA9 yy \xE2\x82\xAC zz";
+    heap += std::string("ab\0\xFF", 4);
+    std::vector<ritsuko::hdf5::vls::Pointer<uint64_t, uint64_t> > pointers {
+        { 3, 5 },
+        { 0, 2 },
+        { 12, 3 },
+        { 5, 0 },
+        { 18, 4 }, // NUL-terminated so the trailing 0xFF is ignored.
+        { 9, 3 }
+    };
+
+    auto create = [&](const std::vector<hsize_t>& dims) -> void {
+        H5::H5File handle(path, H5F_ACC_TRUNC);
+        hsize_t hlen = heap.size();
+        H5::DataSpace hspace(1, &hlen);
+        auto hhandle = handle.createDataSet("heap", H5::PredType::NATIVE_UINT8, hspace);
+        hhandle.write(heap.data(), H5::PredType::NATIVE_UCHAR);
+
+        H5::DataSpace pspace(dims.size(), dims.data());
+        auto ptype = ritsuko::hdf5::vls::define_pointer_datatype<uint64_t, uint64_t>();
+        H5::DSetCreatPropList cplist;
+        if (dims.size() == 2) {
+            std::vector<hsize_t> chunks { 2, 1 };
+            cplist.setChunk(2, chunks.data());
+        }
+        auto phandle = handle.createDataSet("pointers", ptype, pspace, cplist);
+        phandle.write(pointers.data(), ptype);
+    };
+
+    auto check = [&](const std::vector<hsize_t>& dims, const std::string& msg) -> void {
+        create(dims);
+        for (hsize_t buffer_size : { 1, 2, 100 }) {
+            for (int nthreads : { 1, 3 }) {
+                H5::H5File handle(path, H5F_ACC_RDONLY);
+                auto phandle = handle.openDataSet("pointers");
+                auto hhandle = handle.openDataSet("heap");
+                auto run = [&]() -> void {
+                    takane::internal_hdf5::validate_vls_pointers(phandle, dims, hhandle, heap.size(), buffer_size, nthreads, true);
+                };
+
+                if (msg.empty()) {
+                    run();
+                } else {
+                    EXPECT_ANY_THROW({
+                        try {
+                            run();
+                        } catch (std::exception& e) {
+                            EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+                            throw;
+                        }
+                    });
+                }
+            }
+        }
+    };
+
+    std::vector<std::vector<hsize_t> > all_dims { { 6 }, { 3, 2 } };
+    for (const auto& dims : all_dims) {
+        check(dims, "");
+    }
+
+    // Extending a string to include the first two bytes of the euro sign.
+    pointers[5].length = 5;
+    for (const auto& dims : all_dims) {
+        check(dims, "string 5");
+    }
+    pointers[3] = { 12, 2 }; // the earliest invalid string is reported.
+    for (const auto& dims : all_dims) {
+        check(dims, "string 3");
+    }
+
+    // Pointers that are out of range of the heap.
+    pointers[5] = { 9, 3 };
+    pointers[3] = { 5, 0 };
+    pointers[4].length = 5;
+    for (const auto& dims : all_dims) {
+        check(dims, "out of range");
+    }
+    pointers[4] = { heap.size() + 1, 0 };
+    for (const auto& dims : all_dims) {
+        check(dims, "out of range");
+    }
+    pointers[4] = { heap.size(), 0 };
+    for (const auto& dims : all_dims) {
+        check(dims, "");
+    }
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "takane/utils_parallel.hpp"
+
+#include "utils.h"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+TEST(Parallelize, Basic) {
+    for (int nthreads = 1; nthreads <= 4; ++nthreads) {
+        std::vector<int> visited(21);
+        takane::internal_parallel::parallelize(visited.size(), nthreads, [&](size_t job) -> void {
+            ++visited[job];
+        });
+        EXPECT_EQ(visited, std::vector<int>(visited.size(), 1));
+    }
+
+    // Works correctly with no jobs.
+    takane::internal_parallel::parallelize(0, 3, [&](size_t) -> void {
+        throw std::runtime_error("should not be called");
+    });
+}
+
+TEST(Parallelize, Errors) {
+    for (int nthreads = 1; nthreads <= 4; ++nthreads) {
+        // The error from the earliest failing job is always reported.
+        EXPECT_ANY_THROW({
+            try {
+                takane::internal_parallel::parallelize(50, nthreads, [&](size_t job) -> void {
+                    if (job % 7 == 3) {
+                        throw std::runtime_error("failed job " + std::to_string(job));
+                    }
+                });
+            } catch (std::exception& e) {
+                EXPECT_EQ(std::string(e.what()), "failed job 3");
+                throw;
+            }
+        });
+    }
+}
+
+TEST(ParallelizeObjects, Basic) {
+    AssumeThreadsafeHdf5 force; // no HDF5 calls here.
+
+    for (int nthreads = 1; nthreads <= 4; ++nthreads) {
+        takane::Options opts;
+        opts.num_threads = nthreads;
+        opts.parallel_objects = true;
+
+        std::vector<int> visited(21), threads(21);
+        takane::internal_parallel::parallelize_objects(visited.size(), opts, [&](size_t i, takane::Options& object_options) -> void {
+            ++visited[i];
+            threads[i] = object_options.num_threads;
+        });
+        EXPECT_EQ(visited, std::vector<int>(visited.size(), 1));
+        for (auto t : threads) {
+            EXPECT_GE(t, 1);
+            EXPECT_LE(t, nthreads);
+        }
+        EXPECT_EQ(opts.num_threads, nthreads); // caller's options are unchanged.
+
+        // Remaining threads are split between the objects.
+        std::vector<int> split(2);
+        takane::internal_parallel::parallelize_objects(split.size(), opts, [&](size_t i, takane::Options& object_options) -> void {
+            split[i] = object_options.num_threads;
+        });
+        EXPECT_EQ(split, std::vector<int>(2, nthreads == 1 ? 1 : nthreads / 2));
+
+        EXPECT_ANY_THROW({
+            try {
+                takane::internal_parallel::parallelize_objects(50, opts, [&](size_t i, takane::Options&) -> void {
+                    if (i % 7 == 3) {
+                        throw std::runtime_error("failed object " + std::to_string(i));
+                    }
+                });
+            } catch (std::exception& e) {
+                EXPECT_EQ(std::string(e.what()), "failed object 3");
+                throw;
+            }
+        });
+    }
+}
+
+TEST(ParallelizeObjects, OptIn) {
+    takane::Options opts;
+    opts.num_threads = 4;
+    EXPECT_FALSE(takane::internal_parallel::can_parallelize_objects(opts)); // off by default.
+
+    opts.parallel_objects = true;
+    EXPECT_EQ(takane::internal_parallel::can_parallelize_objects(opts), takane::internal_parallel::hdf5_is_threadsafe());
+
+    opts.num_threads = 1;
+    EXPECT_FALSE(takane::internal_parallel::can_parallelize_objects(opts));
+}
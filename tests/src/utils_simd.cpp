@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+
+#include "takane/utils_simd.hpp"
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <limits>
+
+template<typename Type_>
+static size_t reference(const std::vector<Type_>& x, size_t from, Type_ max_allowed) {
+    for (size_t i = from; i < x.size(); ++i) {
+        if (x[i] > max_allowed || x[i] <= x[i - 1]) {
+            return i;
+        }
+    }
+    return x.size();
+}
+
+template<typename Type_>
+static void compare_kernels(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<takane::internal_simd::Instructions> choices { takane::internal_simd::Instructions::NONE };
+    auto available = takane::internal_simd::available_instructions();
+    choices.push_back(available);
+    if (available == takane::internal_simd::Instructions::AVX512) {
+        choices.push_back(takane::internal_simd::Instructions::AVX2);
+    }
+
+    constexpr Type_ type_max = std::numeric_limits<Type_>::max();
+
+    for (size_t iter = 0; iter < 200; ++iter) {
+        size_t n = rng() % 300 + 1;
+        std::vector<Type_> x(n);
+
+        // Creating an increasing sequence with occasional violations.
+        Type_ current = rng() % 5;
+        for (auto& y : x) {
+            y = current;
+            auto step = rng() % 3;
+            if (current <= type_max - step) {
+                current += step;
+            }
+        }
+        for (size_t e = 0, nerr = rng() % 3; e < nerr; ++e) {
+            x[rng() % n] = rng();
+        }
+
+        Type_ max_allowed = (iter % 2 == 0 ? type_max : x[rng() % n]);
+        size_t from = std::min(static_cast<size_t>(rng() % 20 + 1), n);
+        auto expected = reference(x, from, max_allowed);
+
+        for (auto choice : choices) {
+            EXPECT_EQ(takane::internal_simd::find_unsorted_or_out_of_range(x.data(), from, n, max_allowed, choice), expected);
+        }
+    }
+}
+
+TEST(Simd, FindUnsortedOrOutOfRange) {
+    compare_kernels<uint8_t>(1);
+    compare_kernels<uint16_t>(2);
+    compare_kernels<uint32_t>(3);
+    compare_kernels<uint64_t>(4);
+
+    // Values near the top of the range, to check the unsigned comparisons.
+    std::vector<uint64_t> big { 1ull << 63, (1ull << 63) + 1, (1ull << 63) + 2, static_cast<uint64_t>(-1), 0, 1, 2, 3, 4, 5 };
+    EXPECT_EQ(takane::internal_simd::find_unsorted_or_out_of_range(big.data(), 1, big.size(), std::numeric_limits<uint64_t>::max()), 4u);
+    EXPECT_EQ(takane::internal_simd::find_unsorted_or_out_of_range(big.data(), 1, big.size(), static_cast<uint64_t>((1ull << 63) + 1)), 2u);
+
+    std::vector<uint8_t> small { 0, 128, 129, 255, 3, 4 };
+    EXPECT_EQ(takane::internal_simd::find_unsorted_or_out_of_range(small.data(), 1, small.size(), static_cast<uint8_t>(255)), 4u);
+    EXPECT_EQ(takane::internal_simd::find_unsorted_or_out_of_range(small.data(), 1, small.size(), static_cast<uint8_t>(128)), 2u);
+}
+
+template<typename Type_>
+static Type_ reference_masked_max(const std::vector<Type_>& x, Type_ placeholder) {
+    Type_ output = 0;
+    for (auto y : x) {
+        if (y != placeholder && y > output) {
+            output = y;
+        }
+    }
+    return output;
+}
+
+template<typename Type_>
+static void compare_masked_max(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<takane::internal_simd::Instructions> choices { takane::internal_simd::Instructions::NONE };
+    auto available = takane::internal_simd::available_instructions();
+    choices.push_back(available);
+    if (available == takane::internal_simd::Instructions::AVX512) {
+        choices.push_back(takane::internal_simd::Instructions::AVX2);
+    }
+
+    for (size_t iter = 0; iter < 200; ++iter) {
+        size_t n = rng() % 300;
+        std::vector<Type_> x(n);
+        for (auto& y : x) {
+            y = (iter % 2 == 0 ? rng() : rng() % 50);
+        }
+
+        // Sprinkling in lots of placeholders, which are sometimes the largest value.
+        Type_ placeholder = (iter % 3 == 0 ? 0 : (iter % 3 == 1 ? std::numeric_limits<Type_>::max() : static_cast<Type_>(rng())));
+        for (auto& y : x) {
+            if (rng() % 4 == 0) {
+                y = placeholder;
+            }
+        }
+
+        auto expected = reference_masked_max(x, placeholder);
+        for (auto choice : choices) {
+            EXPECT_EQ(takane::internal_simd::masked_max(x.data(), n, placeholder, choice), expected);
+        }
+    }
+}
+
+TEST(Simd, MaskedMax) {
+    compare_masked_max<uint8_t>(5);
+    compare_masked_max<uint16_t>(6);
+    compare_masked_max<uint32_t>(7);
+    compare_masked_max<uint64_t>(8);
+
+    // All values are equal to the placeholder.
+    std::vector<uint32_t> all(100, 12345);
+    EXPECT_EQ(takane::internal_simd::masked_max(all.data(), all.size(), static_cast<uint32_t>(12345)), 0u);
+
+    std::vector<uint64_t> big(100, 5);
+    big[77] = static_cast<uint64_t>(-1);
+    big[33] = 1ull << 63;
+    EXPECT_EQ(takane::internal_simd::masked_max(big.data(), big.size(), static_cast<uint64_t>(0)), static_cast<uint64_t>(-1));
+    EXPECT_EQ(takane::internal_simd::masked_max(big.data(), big.size(), static_cast<uint64_t>(-1)), 1ull << 63);
+}
+
+TEST(Simd, FindNonAscii) {
+    std::mt19937_64 rng(9);
+    std::vector<takane::internal_simd::Instructions> choices { takane::internal_simd::Instructions::NONE };
+    auto available = takane::internal_simd::available_instructions();
+    choices.push_back(available);
+    if (available == takane::internal_simd::Instructions::AVX512) {
+        choices.push_back(takane::internal_simd::Instructions::AVX2);
+    }
+
+    for (size_t iter = 0; iter < 200; ++iter) {
+        size_t n = rng() % 300;
+        std::vector<char> x(n);
+        for (auto& y : x) {
+            y = static_cast<char>(rng() % 128);
+        }
+
+        size_t expected = n;
+        if (n && iter % 4) {
+            expected = rng() % n;
+            x[expected] = static_cast<char>(0x80 + rng() % 128);
+            for (size_t i = expected + 1; i < n; ++i) { // adding more non-ASCII characters after the first.
+                if (rng() % 2) {
+                    x[i] = static_cast<char>(0xC3);
+                }
+            }
+        }
+
+        for (auto choice : choices) {
+            EXPECT_EQ(takane::internal_simd::find_non_ascii(x.data(), n, choice), expected);
+        }
+    }
+}
+
+TEST(Simd, CheckedSum) {
+    std::mt19937_64 rng(10);
+    std::vector<takane::internal_simd::Instructions> choices { takane::internal_simd::Instructions::NONE };
+    auto available = takane::internal_simd::available_instructions();
+    choices.push_back(available);
+    if (available == takane::internal_simd::Instructions::AVX512) {
+        choices.push_back(takane::internal_simd::Instructions::AVX2);
+    }
+
+    for (size_t iter = 0; iter < 200; ++iter) {
+        size_t n = rng() % 300;
+        std::vector<uint64_t> x(n);
+        for (auto& y : x) {
+            y = rng() % 1000000;
+        }
+
+        // Occasionally adding huge values to trigger an overflow.
+        if (n && iter % 3 == 0) {
+            x[rng() % n] = std::numeric_limits<uint64_t>::max() - rng() % 100;
+        }
+
+        uint64_t start = iter % 2;
+        uint64_t expected = start;
+        bool overflow = false;
+        for (auto y : x) {
+            overflow |= (y > std::numeric_limits<uint64_t>::max() - expected);
+            expected += y;
+        }
+
+        for (auto choice : choices) {
+            uint64_t total = start;
+            bool okay = takane::internal_simd::checked_sum(x.data(), n, total, choice);
+            EXPECT_EQ(okay, !overflow);
+            if (okay) {
+                EXPECT_EQ(total, expected);
+            }
+        }
+    }
+
+    // Overflow is still detected if the lanes wrap around exactly.
+    std::vector<uint64_t> wrapped(64, 1ull << 60);
+    for (auto choice : choices) {
+        uint64_t total = 0;
+        EXPECT_FALSE(takane::internal_simd::checked_sum(wrapped.data(), wrapped.size(), total, choice));
+        total = 0;
+        EXPECT_TRUE(takane::internal_simd::checked_sum(wrapped.data(), 15, total, choice));
+        EXPECT_EQ(total, 15ull << 60);
+    }
+}
+
+template<typename Type_>
+static void check_narrow_sum() {
+    std::mt19937_64 rng(20);
+    std::vector<takane::internal_simd::Instructions> choices { takane::internal_simd::Instructions::NONE };
+    auto available = takane::internal_simd::available_instructions();
+    choices.push_back(available);
+    if (available == takane::internal_simd::Instructions::AVX512) {
+        choices.push_back(takane::internal_simd::Instructions::AVX2);
+    }
+
+    for (size_t iter = 0; iter < 100; ++iter) {
+        size_t n = rng() % 300;
+        std::vector<Type_> x(n);
+        for (auto& y : x) {
+            y = rng(); // use the full range to check that values are zero-extended.
+        }
+
+        // Starting near the limit to trigger an overflow.
+        uint64_t start = (iter % 2 ? std::numeric_limits<uint64_t>::max() - rng() % 100000 : iter);
+        uint64_t expected = start;
+        bool overflow = false;
+        for (auto y : x) {
+            overflow |= (y > std::numeric_limits<uint64_t>::max() - expected);
+            expected += y;
+        }
+
+        for (auto choice : choices) {
+            uint64_t total = start;
+            bool okay = takane::internal_simd::checked_sum(x.data(), n, total, choice);
+            EXPECT_EQ(okay, !overflow);
+            if (okay) {
+                EXPECT_EQ(total, expected);
+            }
+        }
+    }
+}
+
+TEST(Simd, CheckedSumNarrow) {
+    check_narrow_sum<uint32_t>();
+    check_narrow_sum<uint16_t>();
+    check_narrow_sum<uint8_t>();
+}
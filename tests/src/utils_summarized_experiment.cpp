@@ -59,3 +59,72 @@ TEST_F(SummarizedExperimentUtilsTest, CheckNames) {
     }
     EXPECT_EQ(takane::internal_summarized_experiment::check_names_json(dir), 3);
 }
+
+static void expect_error_tasks(takane::internal_summarized_experiment::ComponentTasks& tasks, takane::Options& opts, const std::string& msg) {
+    EXPECT_ANY_THROW({
+        try {
+            tasks.run(opts);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(SummarizedExperimentTasks, Basic) {
+    AssumeThreadsafeHdf5 force; // no HDF5 calls in the tasks.
+
+    for (int nthreads : { 1, 3 }) {
+        takane::Options opts;
+        opts.num_threads = nthreads;
+        opts.parallel_objects = true;
+
+        std::vector<int> visited(5);
+        takane::internal_summarized_experiment::ComponentTasks tasks;
+        for (int i = 0; i < 5; ++i) {
+            tasks.add([&visited,i](takane::Options&) -> void { visited[i] = i + 1; });
+        }
+        tasks.run(opts);
+        EXPECT_EQ(visited, std::vector<int>({ 1, 2, 3, 4, 5 }));
+        EXPECT_FALSE(tasks.failed());
+    }
+}
+
+TEST(SummarizedExperimentTasks, Errors) {
+    AssumeThreadsafeHdf5 force; // no HDF5 calls in the tasks.
+
+    for (int nthreads : { 1, 3 }) {
+        takane::Options opts;
+        opts.num_threads = nthreads;
+        opts.parallel_objects = true;
+
+        // Earliest failing task is reported.
+        {
+            takane::internal_summarized_experiment::ComponentTasks tasks;
+            tasks.add([](takane::Options&) -> void {});
+            tasks.add([](takane::Options&) -> void { throw std::runtime_error("first error"); });
+            tasks.add([](takane::Options&) -> void { throw std::runtime_error("second error"); });
+            expect_error_tasks(tasks, opts, "first error");
+        }
+
+        // Planning failures are reported in order, and no more tasks are added.
+        {
+            takane::internal_summarized_experiment::ComponentTasks tasks;
+            bool later = false;
+            tasks.plan([]() -> void { throw std::runtime_error("planning error"); });
+            EXPECT_TRUE(tasks.failed());
+            tasks.add([&later](takane::Options&) -> void { later = true; });
+            tasks.plan([&later]() -> void { later = true; });
+            expect_error_tasks(tasks, opts, "planning error");
+            EXPECT_FALSE(later);
+        }
+
+        // Earlier task failures take precedence over planning failures.
+        {
+            takane::internal_summarized_experiment::ComponentTasks tasks;
+            tasks.add([](takane::Options&) -> void { throw std::runtime_error("task error"); });
+            tasks.plan([]() -> void { throw std::runtime_error("planning error"); });
+            expect_error_tasks(tasks, opts, "task error");
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "takane/utils_utf8.hpp"
+
+#include <string>
+#include <vector>
+
+static bool is_valid_everywhere(const std::string& x) {
+    bool expected = takane::internal_utf8::is_valid(x, takane::internal_simd::Instructions::NONE);
+    EXPECT_EQ(takane::internal_utf8::is_valid(x), expected);
+    return expected;
+}
+
+TEST(Utf8, Valid) {
+    EXPECT_TRUE(is_valid_everywhere(""));
+    EXPECT_TRUE(is_valid_everywhere("hello world"));
+    EXPECT_TRUE(is_valid_everywhere("caf\xC3\xA9"));
+    EXPECT_TRUE(is_valid_everywhere("\xE2\x82\xAC 100")); // Euro sign.
+    EXPECT_TRUE(is_valid_everywhere("\xF0\x9F\x98\x80")); // Emoji.
+    EXPECT_TRUE(is_valid_everywhere("\xED\x9F\xBF")); // U+D7FF, just before the surrogates.
+    EXPECT_TRUE(is_valid_everywhere("\xF4\x8F\xBF\xBF")); // U+10FFFF.
+
+    // Long strings that are mostly ASCII, with multi-byte characters at various positions.
+    for (size_t pos : { 0, 15, 31, 32, 63, 64, 100 }) {
+        std::string x(150, 'a');
+        x.replace(pos, 3, "\xE2\x82\xAC");
+        EXPECT_TRUE(is_valid_everywhere(x));
+    }
+}
+
+TEST(Utf8, Invalid) {
+    EXPECT_FALSE(is_valid_everywhere("\x80"));       // Unexpected continuation byte.
+    EXPECT_FALSE(is_valid_everywhere("caf\xC3"));    // Truncated sequence.
+    EXPECT_FALSE(is_valid_everywhere("\xC3\x28"));   // Invalid continuation byte.
+    EXPECT_FALSE(is_valid_everywhere("\xC0\xAF"));   // Overlong encoding.
+    EXPECT_FALSE(is_valid_everywhere("\xE0\x80\xAF"));
+    EXPECT_FALSE(is_valid_everywhere("\xF0\x80\x80\xAF"));
+    EXPECT_FALSE(is_valid_everywhere("\xED\xA0\x80")); // Surrogate.
+    EXPECT_FALSE(is_valid_everywhere("\xF4\x90\x80\x80")); // Above U+10FFFF.
+    EXPECT_FALSE(is_valid_everywhere("\xF5\x80\x80\x80"));
+    EXPECT_FALSE(is_valid_everywhere("\xFF"));
+
+    for (size_t pos : { 0, 15, 31, 32, 63, 64, 100, 149 }) {
+        std::string x(150, 'a');
+        x[pos] = '\xE2';
+        EXPECT_FALSE(is_valid_everywhere(x));
+    }
+}